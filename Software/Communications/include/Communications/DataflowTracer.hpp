@@ -0,0 +1,110 @@
+/*
+ * DataflowTracer.hpp
+ *
+ *  Created on: August 23, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_DATAFLOWTRACER_H_
+#define NOMAD_REALTIME_DATAFLOWTRACER_H_
+
+// C Includes
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ Includes
+#include <atomic>
+#include <string>
+
+namespace Realtime
+{
+// End to end dataflow tracer.  A trace context is a trace id and the CLOCK_MONOTONIC time (nanoseconds) the data
+// entered the graph (origin).  Port::Send files the context against the message (channel and sequence number) in a
+// process wide table and Port::Receive looks it up, adopting the context of the oldest input, so the context follows
+// a sample through every node without changing the message format.  Messages from another process start a new trace
+// on arrival.  Task cycles are recorded as spans and sends/receives as flow
+// events into preallocated per thread buffers.  WriteChromeTrace() exports Chrome/Perfetto JSON (chrome://tracing,
+// ui.perfetto.dev).
+class DataflowTracer
+{
+
+public:
+    enum EventType
+    {
+        SPAN = 0, // Task cycle
+        SEND,     // Port::Send
+        RECEIVE   // Port::Receive
+    };
+
+    // Trace context carried by a message
+    struct Context
+    {
+        uint64_t trace_id;  // 0 = Untraced
+        uint64_t origin_ns; // Time the data entered the graph
+    };
+
+    // Open span.  Saves the enclosing context so spans can nest (i.e. Cyclic Executive hosted tasks)
+    struct Span
+    {
+        uint64_t start_ns;
+        uint64_t outer_start_ns;
+        Context outer;
+    };
+
+    // Enable tracing.  events_per_thread = Buffer size allocated per thread on registration.  Full buffers drop events
+    static void Enable(const size_t events_per_thread = 16384);
+
+    // Stop recording.  Recorded events are kept for export
+    static void Disable();
+
+    // Tracing on?
+    static inline bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Allocate the calling thread's event buffer.  Call before the hot loop.  Unregistered threads register on first event
+    static void RegisterThread(const std::string &name);
+
+    // Task cycle.  Clears the thread context until a traced input is received
+    static void BeginSpan(Span &span);
+    static void EndSpan(Span &span, const std::string &name);
+
+    // Port hooks.  flow_id is unique per message on a channel
+    static void OnSend(const std::string &channel, const uint64_t flow_id);
+    static void OnReceive(const std::string &channel, const uint64_t flow_id);
+
+    // Write recorded events as Chrome trace event JSON.  Returns false if the file could not be opened
+    static bool WriteChromeTrace(const std::string &path);
+
+    // Print per task span, end to end latency and input queueing statistics
+    static void PrintSummary();
+
+    // CLOCK_MONOTONIC nanoseconds
+    static uint64_t Now();
+
+    // Maximum event name length (task or channel name)
+    static const int MAX_NAME = 48;
+
+    // Messages in flight whose context can be looked up.  Older contexts are overwritten and start a new trace
+    static const int CONTEXT_SLOTS = 4096;
+
+private:
+    static std::atomic_bool enabled_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_DATAFLOWTRACER_H_
@@ -25,6 +25,7 @@
 
 #include <unistd.h>
 #include <assert.h>
+#include <time.h>
 
 #include <iostream>
 #include <chrono>
@@ -34,7 +35,12 @@ namespace Realtime
 {
 
 template <class T>
-PortHandler<T>::PortHandler(int queue_size) : queue_size_(queue_size)
+PortHandler<T>::PortHandler(int queue_size) : msg_buffer_(queue_size > 0 ? queue_size : 1),
+                                               head_(0),
+                                               count_(0),
+                                               queue_size_(queue_size > 0 ? queue_size : 1),
+                                               trigger_fd_(-1),
+                                               arrival_ns_(0)
 {
 }
 
@@ -52,25 +58,49 @@ void PortHandler<T>::HandleMessage(const zcm::ReceiveBuffer *rbuf,
     //printf("Received message on channel \"%s\":\n", chan.c_str());
     //printf("  Message   = %ld\n", msg->sequence_num);
 
-    std::unique_lock<std::mutex> lck(mutex_);
-    if (msg_buffer_.size() >= queue_size_)
+    // Copy before taking the lock
+    staging_ = *msg;
+
     {
-        // Kill Old Message
-        msg_buffer_.pop_front();
+        std::unique_lock<PortMutex> lck(mutex_);
+        if (count_ == queue_size_)
+        {
+            // Kill Old Message
+            head_ = (head_ + 1) % queue_size_;
+            count_--;
+        }
+
+        // Old slot contents come back as the next staging buffer
+        std::swap(msg_buffer_[(head_ + count_) % queue_size_], staging_);
+        count_++;
     }
-    msg_buffer_.push_back(*msg);
 
     //std::cout << msg_buffer_.size() << std::endl;
+
+    // Wake any task triggered on this port.  After the unlock so the woken task does not block on the mutex
+    if (trigger_fd_ >= 0)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        arrival_ns_.store(now.tv_sec * 1000000000ULL + now.tv_nsec, std::memory_order_release);
+
+        const uint64_t event = 1;
+        if (write(trigger_fd_, &event, sizeof(event)) < 0)
+        {
+            // Counter saturated.  Task is already signalled
+        }
+    }
 }
 template <class T>
 const inline bool PortHandler<T>::Read(T &rx_msg)
 {
-    std::unique_lock<std::mutex> lck(mutex_);
-    if (msg_buffer_.empty())
+    std::unique_lock<PortMutex> lck(mutex_);
+    if (count_ == 0)
         return false;
-        
-    rx_msg = msg_buffer_.back();
-    msg_buffer_.pop_back();
+
+    // Newest message.  The caller's previous message takes its slot
+    count_--;
+    std::swap(rx_msg, msg_buffer_[(head_ + count_) % queue_size_]);
     return true;
 }
 
@@ -90,6 +120,12 @@ bool Port::Send(T &tx_msg)
     tx_msg.timestamp = time_now;
     tx_msg.sequence_num = sequence_num_++;
 
+    // Record the trace context of the current cycle against this message
+    if (DataflowTracer::IsEnabled())
+    {
+        DataflowTracer::OnSend(channel_, channel_hash_ ^ tx_msg.sequence_num);
+    }
+
     // Publish
     int rc = context_->publish(channel_, &tx_msg);
 
@@ -101,7 +137,15 @@ bool Port::Send(T &tx_msg)
 template <class T>
 bool Port::Receive(T &rx_msg)
 {
-    return static_cast<PortHandler<T> *>(handler_)->Read(rx_msg);
+    if (!static_cast<PortHandler<T> *>(handler_)->Read(rx_msg))
+        return false;
+
+    // Adopt the sample's trace context
+    if (DataflowTracer::IsEnabled())
+    {
+        DataflowTracer::OnReceive(channel_, channel_hash_ ^ rx_msg.sequence_num);
+    }
+    return true;
 }
 
 } // namespace Realtime
\ No newline at end of file
@@ -27,12 +27,16 @@
 // C Includes
 
 // C++ Includes
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <map>
+#include <vector>
 
 #include <Systems/Time.hpp>
+#include <Communications/DataflowTracer.hpp>
+#include <Communications/PortMutex.hpp>
 
 
 // Third Party Includes
@@ -78,6 +82,8 @@ public:
 
     const std::string& GetName() const { return name_;}
 
+    const std::string& GetChannel() const { return channel_; }
+
     // Transport
     // For INPROC/IPC transport URL should depend on block/noblock?  Not technically necessary to set.
     void SetTransport(const TransportType transport, const std::string &transport_url, const std::string &channel) { 
@@ -85,6 +91,8 @@ public:
         transport_url_ = transport_url;
         channel_ = channel; }
 
+    TransportType GetTransport() const { return transport_type_; }
+
 
     // Signal Labels
     void SetSignalLabel(const int signal_idx, const std::string& label);
@@ -97,6 +105,18 @@ public:
 
     // Bind Port
     bool Bind();
+
+    // Signal an eventfd on every message arrival (Input Ports).  Returns the eventfd or -1 on error
+    int EnableTrigger();
+
+    // CLOCK_MONOTONIC time (nanoseconds) of the last message arrival.  0 if none or not triggered
+    uint64_t GetLastArrival() const;
+
+    // Queue lock protocol (Input Ports) -> PortMutex::PRIORITY_INHERIT.  Set before Connect()
+    void SetLockProtocol(const PortMutex::Protocol protocol);
+
+    // Queue lock counters (Input Ports).  False for ports without a queue
+    bool GetLockCounters(PortMutex::Counters &counters) const;
     
     // Send message type data on port
     template <class T>
@@ -145,8 +165,14 @@ protected:
     // Sequence Number:
     uint64_t sequence_num_;
 
+    // Channel hash.  Combined with the sequence number to identify a message for tracing
+    uint64_t channel_hash_;
+
     // Pointer to Handler
     void *handler_;
+
+    // Arrival Trigger eventfd
+    int trigger_fd_;
 };
 
 template <class T>
@@ -163,29 +189,46 @@ public:
     PortHandler(int queue_size = 20);
     ~PortHandler();
 
-    // Message Handling Callback
+    // Message Handling Callback.  Runs on the ZCM dispatch thread of the port's context
     void HandleMessage(const zcm::ReceiveBuffer *rbuf,
                        const std::string &chan,
                        const T *msg);
 
-protected:
+    // Signal fd (eventfd) on each message arrival.  -1 to disable
+    void SetTrigger(const int fd) { trigger_fd_ = fd; }
+
+    // CLOCK_MONOTONIC time (nanoseconds) of the last triggered arrival
+    uint64_t GetLastArrival() const { return arrival_ns_.load(std::memory_order_acquire); }
 
-    // Get Message Buffer
-    inline std::deque<T>& GetMessageQueue() { return msg_buffer_; }
+    // Queue Lock
+    PortMutex &GetMutex() { return mutex_; }
+
+protected:
 
     // Read Available Messages
     // TODO: Read Backward In Time
     const inline bool Read(T& rx_msg);
-    
-    // Message Buffer
-    std::deque<T> msg_buffer_;
+
+    // Message Buffer.  Fixed ring of preallocated messages.  Messages are swapped in and out under the lock so the
+    // critical section never copies or allocates
+    std::vector<T> msg_buffer_;
+    int head_;
+    int count_;
+
+    // Incoming copy.  Made outside the lock by the ZCM dispatch thread, reuses the storage of a recycled slot
+    T staging_;
 
     // Thread mutex
-    std::mutex mutex_;
+    PortMutex mutex_;
 
     // Queue Size to Buffer
     int queue_size_;
 
+    // Arrival Trigger eventfd
+    int trigger_fd_;
+
+    // Last Triggered Arrival (nanoseconds)
+    std::atomic<uint64_t> arrival_ns_;
 };
 
 class PortManager
@@ -0,0 +1,118 @@
+/*
+ * PortMutex.hpp
+ *
+ *  Created on: September 1, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef NOMAD_REALTIME_PORTMUTEX_H_
+#define NOMAD_REALTIME_PORTMUTEX_H_
+
+// C Includes
+#include <pthread.h>
+#include <stdint.h>
+
+// C++ Includes
+#include <atomic>
+
+namespace Realtime
+{
+// Port queue lock.  A pthread mutex with an optional priority inheritance protocol, so a high priority reader blocked
+// behind a preempted low priority thread (i.e. a plotter or the ZCM dispatch thread) lends it its priority until the
+// unlock.  Counts acquisitions, contended acquisitions and the time spent waiting.  Usable with std::unique_lock.
+class PortMutex
+{
+
+public:
+    enum Protocol
+    {
+        NONE = 0,        // Plain mutex
+        PRIORITY_INHERIT // PTHREAD_PRIO_INHERIT
+    };
+
+    struct Counters
+    {
+        uint64_t acquisitions;  // Lock calls
+        uint64_t contentions;   // Lock calls that found the mutex held
+        uint64_t wait_total_ns; // Time blocked on contended locks
+        uint64_t wait_max_ns;   // Longest contended lock
+    };
+
+    explicit PortMutex(const Protocol protocol = Protocol::PRIORITY_INHERIT);
+    ~PortMutex();
+
+    PortMutex(const PortMutex &) = delete;
+    PortMutex &operator=(const PortMutex &) = delete;
+
+    // Change the protocol.  Only while no thread uses the mutex (i.e. before the port connects).  Falls back to
+    // NONE where priority inheritance is not supported
+    void SetProtocol(const Protocol protocol);
+
+    // Protocol in effect
+    Protocol GetProtocol() const { return protocol_; }
+
+    // Lock.  Uncontended path is a single trylock
+    inline void lock()
+    {
+        if (pthread_mutex_trylock(&mutex_) != 0)
+        {
+            LockContended();
+        }
+        acquisitions_.store(acquisitions_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    inline bool try_lock()
+    {
+        if (pthread_mutex_trylock(&mutex_) != 0)
+            return false;
+
+        acquisitions_.store(acquisitions_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    inline void unlock() { pthread_mutex_unlock(&mutex_); }
+
+    // Snapshot of the counters
+    void GetCounters(Counters &counters) const;
+
+    // Clear the counters
+    void ResetCounters();
+
+protected:
+
+    // Blocking lock with wait timing
+    void LockContended();
+
+    // Initialize mutex_ with a protocol.  Returns the protocol in effect
+    Protocol Initialize(const Protocol protocol);
+
+    // Mutex
+    pthread_mutex_t mutex_;
+
+    // Protocol in effect
+    Protocol protocol_;
+
+    // Counters.  Only written while holding the mutex, read from anywhere
+    std::atomic<uint64_t> acquisitions_;
+    std::atomic<uint64_t> contentions_;
+    std::atomic<uint64_t> wait_total_ns_;
+    std::atomic<uint64_t> wait_max_ns_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_PORTMUTEX_H_
@@ -0,0 +1,425 @@
+/*
+ * DataflowTracer.cpp
+ *
+ *  Created on: August 23, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Primary Include
+#include <Communications/DataflowTracer.hpp>
+
+// C System Includes
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// C++ System Includes
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Realtime
+{
+namespace
+{
+struct Event
+{
+    int type;
+    char name[DataflowTracer::MAX_NAME];
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint64_t trace_id;
+    uint64_t origin_ns;
+    uint64_t flow_id;
+};
+
+// Single writer (owning thread).  Readers only look below count
+struct ThreadBuffer
+{
+    std::string name;
+    pid_t tid;
+    std::vector<Event> events;
+    std::atomic<size_t> count;
+    std::atomic<uint64_t> dropped;
+};
+
+struct ThreadState
+{
+    ThreadBuffer *buffer;
+    DataflowTracer::Context context;
+    uint64_t span_start_ns; // Innermost open span
+    int depth;              // Open spans
+};
+
+// Buffers live until exit so exported events stay valid
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+size_t events_per_thread = 16384;
+uint64_t epoch_ns = 0;
+uint64_t pid_bits = 0;
+std::atomic<uint64_t> next_trace_id(1);
+
+thread_local ThreadState thread_state = {NULL, {0, 0}, 0, 0};
+
+// Context of a message in flight, by flow id.  flow_id is the tag; BUSY while a sender fills the slot
+struct ContextSlot
+{
+    std::atomic<uint64_t> flow_id;
+    std::atomic<uint64_t> trace_id;
+    std::atomic<uint64_t> origin_ns;
+};
+
+const uint64_t BUSY = ~0ULL;
+ContextSlot context_table[DataflowTracer::CONTEXT_SLOTS];
+
+void PublishContext(const uint64_t flow_id, const DataflowTracer::Context &context)
+{
+    ContextSlot &slot = context_table[flow_id % DataflowTracer::CONTEXT_SLOTS];
+
+    // Another sender is filling the slot.  This message goes untraced rather than waiting
+    uint64_t current = slot.flow_id.load(std::memory_order_relaxed);
+    if (current == BUSY || !slot.flow_id.compare_exchange_strong(current, BUSY, std::memory_order_acquire))
+        return;
+
+    slot.trace_id.store(context.trace_id, std::memory_order_relaxed);
+    slot.origin_ns.store(context.origin_ns, std::memory_order_relaxed);
+    slot.flow_id.store(flow_id, std::memory_order_release);
+}
+
+bool LookupContext(const uint64_t flow_id, DataflowTracer::Context &context)
+{
+    ContextSlot &slot = context_table[flow_id % DataflowTracer::CONTEXT_SLOTS];
+    if (slot.flow_id.load(std::memory_order_acquire) != flow_id)
+        return false;
+
+    context.trace_id = slot.trace_id.load(std::memory_order_relaxed);
+    context.origin_ns = slot.origin_ns.load(std::memory_order_relaxed);
+
+    // Overwritten while reading
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.flow_id.load(std::memory_order_relaxed) == flow_id;
+}
+
+// Process id in the upper bits keeps ids unique across the trace files of several processes
+inline uint64_t NewTraceId()
+{
+    return pid_bits | (next_trace_id.fetch_add(1, std::memory_order_relaxed) & 0xFFFFFFFFFFULL);
+}
+
+void Record(const int type, const std::string &name, const uint64_t start_ns, const uint64_t end_ns,
+            const DataflowTracer::Context &context, const uint64_t flow_id)
+{
+    if (thread_state.buffer == NULL)
+    {
+        // Late registration allocates.  RealTimeTaskNode registers before its loop
+        DataflowTracer::RegisterThread("Thread " + std::to_string(syscall(SYS_gettid)));
+    }
+
+    ThreadBuffer *buffer = thread_state.buffer;
+    const size_t n = buffer->count.load(std::memory_order_relaxed);
+    if (n >= buffer->events.size())
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event &event = buffer->events[n];
+    event.type = type;
+    strncpy(event.name, name.c_str(), DataflowTracer::MAX_NAME - 1);
+    event.name[DataflowTracer::MAX_NAME - 1] = '\0';
+    event.start_ns = start_ns;
+    event.end_ns = end_ns;
+    event.trace_id = context.trace_id;
+    event.origin_ns = context.origin_ns;
+    event.flow_id = flow_id;
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+inline double ToMicroseconds(const uint64_t ns)
+{
+    return ns < epoch_ns ? 0.0 : (ns - epoch_ns) / 1000.0;
+}
+} // namespace
+
+std::atomic_bool DataflowTracer::enabled_(false);
+
+uint64_t DataflowTracer::Now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void DataflowTracer::Enable(const size_t events)
+{
+    {
+        std::unique_lock<std::mutex> lck(registry_mutex);
+        events_per_thread = events;
+        if (epoch_ns == 0)
+        {
+            epoch_ns = Now();
+            pid_bits = (uint64_t)(getpid() & 0xFFFFFF) << 40;
+        }
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+    std::cout << "[DataflowTracer]: Tracing enabled.  " << events << " events per thread" << std::endl;
+}
+
+void DataflowTracer::Disable()
+{
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+void DataflowTracer::RegisterThread(const std::string &name)
+{
+    std::unique_lock<std::mutex> lck(registry_mutex);
+    if (thread_state.buffer != NULL)
+    {
+        thread_state.buffer->name = name;
+        return;
+    }
+
+    std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+    buffer->name = name;
+    buffer->tid = syscall(SYS_gettid);
+    buffer->events.resize(events_per_thread);
+    buffer->count = 0;
+    buffer->dropped = 0;
+
+    thread_state.buffer = buffer.get();
+    registry.push_back(std::move(buffer));
+}
+
+void DataflowTracer::BeginSpan(Span &span)
+{
+    span.start_ns = Now();
+    span.outer = thread_state.context;
+    span.outer_start_ns = thread_state.span_start_ns;
+    thread_state.span_start_ns = span.start_ns;
+    thread_state.context.trace_id = 0;
+    thread_state.context.origin_ns = 0;
+    thread_state.depth++;
+}
+
+void DataflowTracer::EndSpan(Span &span, const std::string &name)
+{
+    Record(EventType::SPAN, name, span.start_ns, Now(), thread_state.context, 0);
+    thread_state.context = span.outer;
+    thread_state.span_start_ns = span.outer_start_ns;
+    thread_state.depth--;
+}
+
+void DataflowTracer::OnSend(const std::string &channel, const uint64_t flow_id)
+{
+    const uint64_t now = Now();
+
+    // No traced input this cycle.  Data originates here, at the start of the cycle that produced it
+    Context context = thread_state.context;
+    if (context.trace_id == 0)
+    {
+        context.trace_id = NewTraceId();
+        context.origin_ns = thread_state.depth > 0 ? thread_state.span_start_ns : now;
+
+        // Later sends in the same cycle belong to the same trace
+        if (thread_state.depth > 0)
+        {
+            thread_state.context = context;
+        }
+    }
+
+    PublishContext(flow_id, context);
+    Record(EventType::SEND, channel, now, now, context, flow_id);
+}
+
+void DataflowTracer::OnReceive(const std::string &channel, const uint64_t flow_id)
+{
+    const uint64_t now = Now();
+
+    // Sent by another process, or its context was overwritten.  Trace starts on arrival
+    Context context = {0, 0};
+    if (!LookupContext(flow_id, context) || context.trace_id == 0)
+    {
+        context.trace_id = NewTraceId();
+        context.origin_ns = now;
+    }
+
+    // Follow the oldest input.  That is the critical path through this node
+    if (thread_state.depth > 0 && (thread_state.context.trace_id == 0 || context.origin_ns < thread_state.context.origin_ns))
+    {
+        thread_state.context = context;
+    }
+
+    Record(EventType::RECEIVE, channel, now, now, context, flow_id);
+}
+
+bool DataflowTracer::WriteChromeTrace(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == NULL)
+    {
+        std::cout << "[DataflowTracer]: ERROR: Failed to open " << path << std::endl;
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lck(registry_mutex);
+    const int pid = getpid();
+
+    // Send times for queueing delay on the matching receive
+    std::map<uint64_t, uint64_t> send_times;
+    for (auto &buffer : registry)
+    {
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (buffer->events[i].type == EventType::SEND)
+                send_times[buffer->events[i].flow_id] = buffer->events[i].start_ns;
+        }
+    }
+
+    size_t written = 0;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (auto &buffer : registry)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                written++ ? ",\n" : "", pid, buffer->tid, buffer->name.c_str());
+
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++)
+        {
+            const Event &event = buffer->events[i];
+            if (event.type == EventType::SPAN)
+            {
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,"
+                              "\"args\":{\"trace_id\":\"0x%lx\",\"latency_us\":%.3f}}",
+                        event.name, ToMicroseconds(event.start_ns), (event.end_ns - event.start_ns) / 1000.0, pid, buffer->tid,
+                        (unsigned long)event.trace_id, event.trace_id ? (event.end_ns - event.origin_ns) / 1000.0 : 0.0);
+            }
+            else if (event.type == EventType::SEND)
+            {
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"port\",\"ph\":\"s\",\"id\":\"0x%lx\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+                              "\"args\":{\"trace_id\":\"0x%lx\"}}",
+                        event.name, (unsigned long)event.flow_id, ToMicroseconds(event.start_ns), pid, buffer->tid,
+                        (unsigned long)event.trace_id);
+            }
+            else
+            {
+                auto sent = send_times.find(event.flow_id);
+                const double queue_us = sent != send_times.end() ? (event.start_ns - sent->second) / 1000.0 : 0.0;
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"port\",\"ph\":\"f\",\"bp\":\"e\",\"id\":\"0x%lx\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+                              "\"args\":{\"trace_id\":\"0x%lx\",\"queue_us\":%.3f}}",
+                        event.name, (unsigned long)event.flow_id, ToMicroseconds(event.start_ns), pid, buffer->tid,
+                        (unsigned long)event.trace_id, queue_us);
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    std::cout << "[DataflowTracer]: Wrote trace to " << path << std::endl;
+    return true;
+}
+
+void DataflowTracer::PrintSummary()
+{
+    struct Summary
+    {
+        uint64_t count;
+        uint64_t total_ns;
+        uint64_t max_ns;
+        uint64_t total_latency_ns;
+        uint64_t max_latency_ns;
+    };
+
+    std::map<std::string, Summary> spans;
+    std::map<std::string, Summary> channels;
+    std::map<uint64_t, uint64_t> send_times;
+
+    std::unique_lock<std::mutex> lck(registry_mutex);
+    for (auto &buffer : registry)
+    {
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++)
+        {
+            const Event &event = buffer->events[i];
+            if (event.type == EventType::SEND)
+            {
+                send_times[event.flow_id] = event.start_ns;
+            }
+            else if (event.type == EventType::SPAN)
+            {
+                Summary &summary = spans[event.name];
+                const uint64_t run_ns = event.end_ns - event.start_ns;
+                const uint64_t latency_ns = event.trace_id ? event.end_ns - event.origin_ns : 0;
+                summary.count++;
+                summary.total_ns += run_ns;
+                summary.max_ns = std::max(summary.max_ns, run_ns);
+                summary.total_latency_ns += latency_ns;
+                summary.max_latency_ns = std::max(summary.max_latency_ns, latency_ns);
+            }
+        }
+    }
+
+    // Queueing: Send to Receive on each channel
+    for (auto &buffer : registry)
+    {
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++)
+        {
+            const Event &event = buffer->events[i];
+            auto sent = send_times.find(event.flow_id);
+            if (event.type != EventType::RECEIVE || sent == send_times.end())
+                continue;
+
+            Summary &summary = channels[event.name];
+            const uint64_t queue_ns = event.start_ns - sent->second;
+            summary.count++;
+            summary.total_ns += queue_ns;
+            summary.max_ns = std::max(summary.max_ns, queue_ns);
+        }
+    }
+
+    std::cout << "[DataflowTracer]: Task Spans: " << std::endl;
+    for (auto &span : spans)
+    {
+        const Summary &summary = span.second;
+        std::cout << "[DataflowTracer]: \t" << span.first << "\tSpans: " << summary.count
+                  << "\tRun Mean/Max: " << summary.total_ns / summary.count / 1000.0 << "/" << summary.max_ns / 1000.0 << " us"
+                  << "\tEnd to End Mean/Max: " << summary.total_latency_ns / summary.count / 1000.0 << "/" << summary.max_latency_ns / 1000.0 << " us" << std::endl;
+    }
+
+    std::cout << "[DataflowTracer]: Channel Queueing: " << std::endl;
+    for (auto &channel : channels)
+    {
+        const Summary &summary = channel.second;
+        std::cout << "[DataflowTracer]: \t" << channel.first << "\tMessages: " << summary.count
+                  << "\tQueue Mean/Max: " << summary.total_ns / summary.count / 1000.0 << "/" << summary.max_ns / 1000.0 << " us" << std::endl;
+    }
+
+    for (auto &buffer : registry)
+    {
+        if (buffer->dropped > 0)
+            std::cout << "[DataflowTracer]: \t" << buffer->name << "\tDropped Events: " << buffer->dropped << std::endl;
+    }
+}
+} // namespace Realtime
@@ -28,6 +28,7 @@
 #include <sched.h>
 #include <unistd.h>
 #include <assert.h>
+#include <sys/eventfd.h>
 
 #include <iostream>
 #include <string>
@@ -39,7 +40,7 @@
 namespace Realtime
 {
 
-Port::Port(const std::string &name, Direction direction, DataType data_type, int dimension, int period) : direction_(direction), data_type_(data_type), name_(name), update_period_(period), sequence_num_(0), dimension_(dimension)
+Port::Port(const std::string &name, Direction direction, DataType data_type, int dimension, int period) : direction_(direction), data_type_(data_type), name_(name), update_period_(period), sequence_num_(0), dimension_(dimension), channel_hash_(0), handler_(NULL), trigger_fd_(-1)
 {
     queue_size_ = 1;
     transport_type_ = TransportType::INPROC;
@@ -84,10 +85,13 @@ bool Port::Map(std::shared_ptr<Port> input, std::shared_ptr<Port> output)
     input->dimension_ = output->dimension_;
     input->data_type_ = output->data_type_;
     input->signal_labels_ = output->signal_labels_;
+    return true;
 }
 
 bool Port::Bind()
 {
+    channel_hash_ = std::hash<std::string>()(channel_);
+
     // Reset and Clear Reference
     context_.reset();
 
@@ -118,6 +122,8 @@ bool Port::Bind()
 
 bool Port::Connect()
 {
+    channel_hash_ = std::hash<std::string>()(channel_);
+
     // Reset and Clear Reference
     context_.reset();
 
@@ -164,6 +170,62 @@ bool Port::Connect()
     return true;
 }
 
+int Port::EnableTrigger()
+{
+    if (direction_ != Direction::INPUT || handler_ == NULL)
+    {
+        std::cout << "[PORT:TRIGGER]: ERROR: Only Input Ports can trigger!" << std::endl;
+        return -1;
+    }
+
+    if (trigger_fd_ < 0)
+    {
+        trigger_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (trigger_fd_ < 0)
+        {
+            std::cout << "[PORT:TRIGGER]: ERROR: Failed to create eventfd!" << std::endl;
+            return -1;
+        }
+    }
+
+    // TODO: Switch Types
+    if (data_type_ == DataType::DOUBLE)
+    {
+        static_cast<PortHandler<double_vec_t> *>(handler_)->SetTrigger(trigger_fd_);
+    }
+    else
+    {
+        std::cout << "[PORT:TRIGGER]: ERROR: Unsupported Data Type! : " << data_type_ << std::endl;
+        return -1;
+    }
+    return trigger_fd_;
+}
+
+uint64_t Port::GetLastArrival() const
+{
+    if (trigger_fd_ < 0 || data_type_ != DataType::DOUBLE)
+        return 0;
+
+    return static_cast<PortHandler<double_vec_t> *>(handler_)->GetLastArrival();
+}
+
+void Port::SetLockProtocol(const PortMutex::Protocol protocol)
+{
+    if (handler_ == NULL || data_type_ != DataType::DOUBLE)
+        return;
+
+    static_cast<PortHandler<double_vec_t> *>(handler_)->GetMutex().SetProtocol(protocol);
+}
+
+bool Port::GetLockCounters(PortMutex::Counters &counters) const
+{
+    if (handler_ == NULL || data_type_ != DataType::DOUBLE)
+        return false;
+
+    static_cast<PortHandler<double_vec_t> *>(handler_)->GetMutex().GetCounters(counters);
+    return true;
+}
+
 ///////////////////////
 // Port Manager Source
 ///////////////////////
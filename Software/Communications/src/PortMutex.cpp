@@ -0,0 +1,120 @@
+/*
+ * PortMutex.cpp
+ *
+ *  Created on: September 1, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <Communications/PortMutex.hpp>
+
+#include <time.h>
+
+#include <iostream>
+
+namespace Realtime
+{
+static inline uint64_t MonotonicNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+PortMutex::PortMutex(const Protocol protocol) : acquisitions_(0),
+                                                contentions_(0),
+                                                wait_total_ns_(0),
+                                                wait_max_ns_(0)
+{
+    protocol_ = Initialize(protocol);
+}
+
+PortMutex::~PortMutex()
+{
+    pthread_mutex_destroy(&mutex_);
+}
+
+void PortMutex::SetProtocol(const Protocol protocol)
+{
+    if (protocol == protocol_)
+        return;
+
+    pthread_mutex_destroy(&mutex_);
+    protocol_ = Initialize(protocol);
+}
+
+PortMutex::Protocol PortMutex::Initialize(const Protocol protocol)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+
+    Protocol result = Protocol::NONE;
+    if (protocol == Protocol::PRIORITY_INHERIT)
+    {
+        if (pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT) == 0)
+        {
+            result = Protocol::PRIORITY_INHERIT;
+        }
+        else
+        {
+            std::cout << "[PortMutex]: Priority inheritance not supported.  Using a plain mutex." << std::endl;
+        }
+    }
+
+    if (pthread_mutex_init(&mutex_, &attr) != 0 && result == Protocol::PRIORITY_INHERIT)
+    {
+        // Kernel without PI futexes
+        std::cout << "[PortMutex]: Priority inheritance mutex init failed.  Using a plain mutex." << std::endl;
+        pthread_mutex_init(&mutex_, NULL);
+        result = Protocol::NONE;
+    }
+
+    pthread_mutexattr_destroy(&attr);
+    return result;
+}
+
+void PortMutex::LockContended()
+{
+    const uint64_t start = MonotonicNanoseconds();
+    pthread_mutex_lock(&mutex_);
+    const uint64_t wait = MonotonicNanoseconds() - start;
+
+    // Held from here on.  Plain load/store is enough
+    contentions_.store(contentions_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    wait_total_ns_.store(wait_total_ns_.load(std::memory_order_relaxed) + wait, std::memory_order_relaxed);
+    if (wait > wait_max_ns_.load(std::memory_order_relaxed))
+    {
+        wait_max_ns_.store(wait, std::memory_order_relaxed);
+    }
+}
+
+void PortMutex::GetCounters(Counters &counters) const
+{
+    counters.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+    counters.contentions = contentions_.load(std::memory_order_relaxed);
+    counters.wait_total_ns = wait_total_ns_.load(std::memory_order_relaxed);
+    counters.wait_max_ns = wait_max_ns_.load(std::memory_order_relaxed);
+}
+
+void PortMutex::ResetCounters()
+{
+    acquisitions_ = 0;
+    contentions_ = 0;
+    wait_total_ns_ = 0;
+    wait_max_ns_ = 0;
+}
+} // namespace Realtime
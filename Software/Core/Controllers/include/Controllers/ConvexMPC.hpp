@@ -30,9 +30,11 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
 
 // Project Include Files
 #include <Realtime/RealTimeTask.hpp>
+#include <Realtime/ParameterStore.hpp>
 #include <Communications/Messages/double_vec_t.hpp>
 #include <OptimalControl/OptimalControlProblem.hpp>
 #include <OptimalControl/LinearCondensedOCP.hpp>
@@ -79,6 +81,12 @@ protected:
     // Pre-Run Setup Routine.  Setup any one time initialization here.
     virtual void Setup();
 
+    // Push the "mpc.Q"/"mpc.R" weights into the OCP
+    void ApplyWeights();
+
+    // Rebuild the OCP for a new "mpc.horizon"
+    void ApplyHorizon();
+
     // Optimal Control Problem
     std::unique_ptr<OptimalControl::LinearOptimalControl::LinearCondensedOCP> ocp_;
 
@@ -87,6 +95,11 @@ protected:
     RigidBlock1D block_;
 
     // State/Input Weights
+    Realtime::Parameter<std::vector<double>> Q_param_;
+    Realtime::Parameter<std::vector<double>> R_param_;
+
+    // Prediction Steps (Live)
+    Realtime::Parameter<int64_t> horizon_param_;
 
     // Number of System States
     unsigned int num_states_;
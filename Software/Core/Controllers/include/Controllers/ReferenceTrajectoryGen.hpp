@@ -35,6 +35,7 @@
 
 // Project Include Files
 #include <Realtime/RealTimeTask.hpp>
+#include <Realtime/ParameterStore.hpp>
 #include <Communications/Messages/double_vec_t.hpp>
 
 namespace Controllers
@@ -72,6 +73,9 @@ protected:
     // Pre-Run Setup Routine.  Setup any one time initialization here.
     virtual void Setup();
 
+    // Resize the trajectory for a new "mpc.horizon"
+    void ApplyHorizon();
+
     // Trajectory State
     Eigen::MatrixXd X_ref_;
 
@@ -87,6 +91,12 @@ protected:
     // Horizon Length
     double T_;   
 
+    // Forward position target (Live)
+    Realtime::Parameter<double> x_target_param_;
+
+    // Sample Points (Live, shared with the MPC)
+    Realtime::Parameter<int64_t> horizon_param_;
+
     // Input (State Estimate)
     double_vec_t x_hat_in_;
 
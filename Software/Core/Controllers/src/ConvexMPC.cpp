@@ -34,6 +34,7 @@
 
 // Project Includes
 #include <Realtime/RealTimeTask.hpp>
+#include <Realtime/RealTimeLog.hpp>
 
 namespace Controllers
 {
@@ -57,16 +58,17 @@ ConvexMPC::ConvexMPC(const std::string &name, const unsigned int N, const double
     // Create Rigid Body
     block_ = RigidBlock1D(1.0, Eigen::Vector3d(1.0, 0.5, 0.25), T_s_);
     //std::cout << "BLOCK: " << T_s_ << std::endl;
-    // State Weights
-    Eigen::VectorXd Q(2);
-    Q[0] = 100.0;
-    Q[1] = 1.0;
-
-    // Input Weights
-    Eigen::VectorXd R(1);
-    R[0] = 0.1;
-
-    ocp_->SetWeights(Q, R);
+    // State/Input Weights.  Tunable live
+    Realtime::ParameterStore *params = Realtime::ParameterStore::Instance();
+    Q_param_ = params->Declare("mpc.Q", std::vector<double>{100.0, 1.0});
+    R_param_ = params->Declare("mpc.R", std::vector<double>{0.1});
+    horizon_param_ = params->Declare("mpc.horizon", (int64_t)N_);
+    ApplyHorizon();
+    ApplyWeights();
+
+    OnParameterChange(Q_param_, [this]() { ApplyWeights(); });
+    OnParameterChange(R_param_, [this]() { ApplyWeights(); });
+    OnParameterChange(horizon_param_, [this]() { ApplyHorizon(); });
 
     // Create Messages
     force_output_.length = num_inputs_;
@@ -103,6 +105,12 @@ void ConvexMPC::Run()
    // std::cout << "SIZE: " << reference_in_.length << std::endl;
    // std::cout << "SIZE: " << num_states_*N_ << std::endl;
 
+    // Reference still sized for the previous horizon
+    if (reference_in_.data.size() != num_states_ * N_)
+    {
+        return;
+    }
+
     Eigen::VectorXd x_hat_ = Eigen::Map<Eigen::VectorXd>(x_hat_in_.data.data(), num_states_);
     Eigen::MatrixXd X_ref_ = Eigen::Map<Eigen::MatrixXd>(reference_in_.data.data(), num_states_, N_);
      //std::cout <<  X_ref_ << std::endl;
@@ -147,6 +155,41 @@ void ConvexMPC::Run()
     // Output Optimal Forces
     bool send_status = GetOutputPort(OutputPort::FORCES)->Send(force_output_);
 }
+void ConvexMPC::ApplyWeights()
+{
+    Realtime::ParameterStore::ReadGuard params;
+    const std::vector<double> &Q = params.Get(Q_param_);
+    const std::vector<double> &R = params.Get(R_param_);
+
+    if (Q.size() != 2 || R.size() != 1)
+    {
+        // Runs on the task thread when the weights change.  Never block it on the stream
+        Realtime::RealTimeLog::Print("[ConvexMPC]: Ignoring weights.  Q needs 2 entries and R 1.");
+        return;
+    }
+
+    ocp_->SetWeights(Eigen::Map<const Eigen::VectorXd>(Q.data(), Q.size()), Eigen::Map<const Eigen::VectorXd>(R.data(), R.size()));
+}
+
+void ConvexMPC::ApplyHorizon()
+{
+    int64_t N;
+    {
+        Realtime::ParameterStore::ReadGuard params;
+        N = params.Get(horizon_param_);
+    }
+
+    if (N < 2 || N == N_)
+        return;
+
+    // Same window, finer or coarser steps
+    N_ = N;
+    T_s_ = T_ / N_;
+    block_ = RigidBlock1D(1.0, Eigen::Vector3d(1.0, 0.5, 0.25), T_s_);
+    ocp_ = std::make_unique<OptimalControl::LinearOptimalControl::LinearCondensedOCP>(N_, T_, 2, 1, false);
+    ApplyWeights();
+}
+
 void ConvexMPC::Setup()
 {
     // Connect Input Ports
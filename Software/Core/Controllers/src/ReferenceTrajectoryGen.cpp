@@ -37,6 +37,7 @@
 
 // Project Includes
 #include <Realtime/RealTimeTask.hpp>
+#include <Systems/Time.hpp>
 
 // TODO: Static Variable in "Physics" Class somewhere
 
@@ -74,6 +75,15 @@ ReferenceTrajectoryGenerator::ReferenceTrajectoryGenerator(const std::string &na
     input_port_map_[InputPort::STATE_HAT] = std::make_shared<Realtime::Port>("STATE_HAT", Realtime::Port::Direction::INPUT, Realtime::Port::DataType::DOUBLE, num_states_, rt_period_);
 
     input_port_map_[InputPort::SETPOINT] = std::make_shared<Realtime::Port>("SETPOINT", Realtime::Port::Direction::INPUT, Realtime::Port::DataType::DOUBLE, 4, rt_period_);
+
+    // Tunable live
+    x_target_param_ = Realtime::ParameterStore::Instance()->Declare("reference.x_target", 7.5);
+
+    // Horizon shared with ConvexMPC, which sizes its reference input from it.  Build both with the same N, the store
+    // warns if the defaults differ
+    horizon_param_ = Realtime::ParameterStore::Instance()->Declare("mpc.horizon", (int64_t)N_);
+    ApplyHorizon();
+    OnParameterChange(horizon_param_, [this]() { ApplyHorizon(); });
 }
 
 void ReferenceTrajectoryGenerator::Run()
@@ -90,8 +100,7 @@ void ReferenceTrajectoryGenerator::Run()
     }
 
     // Get Timestamp
-    // TODO: "GetUptime" Static function in a time class
-    uint64_t time_now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    uint64_t time_now = Systems::Time::GetTime();
     Eigen::VectorXd x_hat_ = Eigen::Map<Eigen::VectorXd>(x_hat_in_.data.data(), 13);
 
     double x_dot = setpoint_in_.data[0];
@@ -99,8 +108,14 @@ void ReferenceTrajectoryGenerator::Run()
     double yaw_dot = setpoint_in_.data[2];
     double z_com = setpoint_in_.data[3];
 
+    double x_target;
+    {
+        Realtime::ParameterStore::ReadGuard params;
+        x_target = params.Get(x_target_param_);
+    }
+
     // Compute Trajectory
-    X_ref_(0,0) = 7.5;//x_hat_in_.data[0]; // X Position
+    X_ref_(0,0) = x_target;//x_hat_in_.data[0]; // X Position
     X_ref_(1,0) = x_hat_in_.data[1]; // Y Position
     X_ref_.row(2).setConstant(z_com); // Z Position
 
@@ -128,7 +143,7 @@ void ReferenceTrajectoryGenerator::Run()
 
     for(int i = 0;i < N_-1; i++)
     {
-        X_ref_(0,i+1) = 7.5;//X_ref_(0,i) + x_dot * T_s_;
+        X_ref_(0,i+1) = x_target;//X_ref_(0,i) + x_dot * T_s_;
         X_ref_(1,i+1) = X_ref_(1,i) + y_dot * T_s_;
         X_ref_(8,i+1) = X_ref_(8,i) + yaw_dot * T_s_;
     }
@@ -141,6 +156,24 @@ void ReferenceTrajectoryGenerator::Run()
     bool send_status = GetOutputPort(OutputPort::REFERENCE)->Send(reference_out_);
 }
 
+void ReferenceTrajectoryGenerator::ApplyHorizon()
+{
+    int64_t N;
+    {
+        Realtime::ParameterStore::ReadGuard params;
+        N = params.Get(horizon_param_);
+    }
+
+    if (N < 2 || N == N_)
+        return;
+
+    N_ = N;
+    T_s_ = T_ / N_;
+    X_ref_.resize(num_states_, N_);
+    reference_out_.length = X_ref_.size();
+    reference_out_.data.resize(reference_out_.length);
+}
+
 void ReferenceTrajectoryGenerator::Setup()
 {
 
@@ -37,6 +37,7 @@
 
 // Project Includes
 #include <Realtime/RealTimeTask.hpp>
+#include <Realtime/RealTimeLog.hpp>
 #include <Communications/Messages/double_vec_t.hpp>
 #include <Systems/Time.hpp>
 
@@ -99,7 +100,7 @@ void StateEstimator::Run()
     bool imu_recv = GetInputPort(InputPort::IMU)->Receive(x_hat_in_); // Receive Setpoint
     if (!imu_recv)
     {
-        std::cout << "[StateEstimator]: Receive Buffer Empty!" << std::endl;
+        Realtime::RealTimeLog::Print("[StateEstimator]: Receive Buffer Empty!");
         return;
     }
 
@@ -0,0 +1,131 @@
+#include <Realtime/RealTimeTask.hpp>
+#include <Realtime/LockstepRunner.hpp>
+#include <Communications/Port.hpp>
+#include <Communications/Messages/double_vec_t.hpp>
+#include <Controllers/StateEstimator.hpp>
+#include <Controllers/ConvexMPC.hpp>
+#include <Controllers/ReferenceTrajectoryGen.hpp>
+#include <OperatorInterface/RemoteTeleop.hpp>
+#include <Systems/RigidBody.hpp>
+
+#include <chrono>
+#include <memory>
+
+// Teleop -> Estimator -> Reference -> MPC stepped in lockstep on simulated time, as fast as the CPU allows.  The main
+// thread closes the loop: it publishes the plant state as the estimator's IMU input before every frame and steps a
+// rigid block with the MPC force after it.  Same inputs, same outputs on every run.
+int main()
+{
+    // Task Periods.
+    int freq1 = 50;
+    int freq2 = 100;
+
+    // Horizons
+    const int N = 16;
+    const double T = 1.5;
+
+    // Simulated run (seconds)
+    const double duration = 10.0;
+
+    Realtime::RealTimeTaskManager::Instance();
+    Realtime::PortManager::Instance();
+
+    // Remote Teleop Task
+    OperatorInterface::Teleop::RemoteTeleop teleop_node("Remote_Teleop");
+    teleop_node.SetTaskFrequency(freq1); // 50 HZ
+    teleop_node.SetPortOutput(OperatorInterface::Teleop::RemoteTeleop::OutputPort::SETPOINT,
+                              Realtime::Port::TransportType::INPROC, "inproc", "nomad.setpoint");
+
+    // State Estimator
+    Controllers::Estimators::StateEstimator estimator_node("Estimator_Task");
+    estimator_node.SetTaskFrequency(freq2); // 100 HZ
+    estimator_node.SetPortOutput(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT,
+                                 Realtime::Port::TransportType::INPROC, "inproc", "nomad.state");
+
+    //Reference Trajectory Generator
+    Controllers::Locomotion::ReferenceTrajectoryGenerator ref_generator_node("Reference_Trajectory_Task", N, T);
+    ref_generator_node.SetTaskFrequency(freq1); // 50 HZ
+    ref_generator_node.SetPortOutput(Controllers::Locomotion::ReferenceTrajectoryGenerator::OutputPort::REFERENCE,
+                                     Realtime::Port::TransportType::INPROC, "inproc", "nomad.reference");
+
+    Realtime::Port::Map(ref_generator_node.GetInputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::InputPort::STATE_HAT),
+                        estimator_node.GetOutputPort(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT));
+
+    Realtime::Port::Map(ref_generator_node.GetInputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::InputPort::SETPOINT),
+                        teleop_node.GetOutputPort(OperatorInterface::Teleop::RemoteTeleop::OutputPort::SETPOINT));
+
+    // Convex Model Predicive Controller for Locomotion.  INPROC so the plant below sees the force in the same frame
+    Controllers::Locomotion::ConvexMPC convex_mpc_node("Convex_MPC_Task", N, T);
+    convex_mpc_node.SetTaskFrequency(freq1); // 50 HZ
+    convex_mpc_node.SetPortOutput(Controllers::Locomotion::ConvexMPC::OutputPort::FORCES, Realtime::Port::TransportType::INPROC, "inproc", "nomad.forces");
+
+    Realtime::Port::Map(convex_mpc_node.GetInputPort(Controllers::Locomotion::ConvexMPC::InputPort::STATE_HAT),
+                        estimator_node.GetOutputPort(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT));
+
+    Realtime::Port::Map(convex_mpc_node.GetInputPort(Controllers::Locomotion::ConvexMPC::InputPort::REFERENCE_TRAJECTORY),
+                        ref_generator_node.GetOutputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::OutputPort::REFERENCE));
+
+    // Simulated plant ports, driven from this thread
+    std::shared_ptr<Realtime::Port> SIM_IMU = std::make_shared<Realtime::Port>("SIM_IMU", Realtime::Port::Direction::OUTPUT, Realtime::Port::DataType::DOUBLE, 13, 10);
+    SIM_IMU->SetTransport(Realtime::Port::TransportType::INPROC, "inproc", "nomad.imu");
+    Realtime::Port::Map(estimator_node.GetInputPort(Controllers::Estimators::StateEstimator::InputPort::IMU), SIM_IMU);
+
+    std::shared_ptr<Realtime::Port> SIM_FORCES = std::make_shared<Realtime::Port>("SIM_FORCES", Realtime::Port::Direction::INPUT, Realtime::Port::DataType::DOUBLE, 1, 20);
+    Realtime::Port::Map(SIM_FORCES, convex_mpc_node.GetOutputPort(Controllers::Locomotion::ConvexMPC::OutputPort::FORCES));
+
+    // Producers before consumers.  The runner orders them by the port graph as well
+    Realtime::LockstepRunner runner("Lockstep");
+    runner.AddTask(&teleop_node);
+    runner.AddTask(&estimator_node);
+    runner.AddTask(&ref_generator_node);
+    runner.AddTask(&convex_mpc_node);
+    if (!runner.Initialize())
+    {
+        return 1;
+    }
+
+    SIM_IMU->Bind();
+    SIM_FORCES->Connect();
+
+    // Plant stepped every minor frame
+    const double T_s = runner.GetMinorFrame() * 1e-6;
+    RigidBlock1D plant(1.0, Eigen::Vector3d(1.0, 0.5, 0.25), T_s);
+
+    double_vec_t imu;
+    imu.length = 13;
+    imu.data.resize(13, 0.0);
+    imu.data[Controllers::Estimators::StateEstimator::GRAVITY] = 9.81;
+
+    double_vec_t forces;
+    double force = 0.0;
+
+    const auto wall_start = std::chrono::steady_clock::now();
+    const uint64_t frames = duration / T_s;
+    for (uint64_t frame = 0; frame < frames; frame++)
+    {
+        // Plant state in, delivered before the estimator runs
+        imu.data[Controllers::Estimators::StateEstimator::X] = plant.GetState()[0];
+        imu.data[Controllers::Estimators::StateEstimator::X_DOT] = plant.GetState()[1];
+        SIM_IMU->Send(imu);
+        Realtime::PortManager::Instance()->GetInprocContext()->flush();
+
+        runner.Step();
+
+        // Force out, held until the next solve
+        if (SIM_FORCES->Receive(forces))
+        {
+            force = forces.data[Controllers::Locomotion::ConvexMPC::U];
+        }
+        plant.Step(force);
+
+        if (frame % 50 == 0)
+        {
+            std::cout << "[Lockstep]: t: " << runner.GetSimulatedTime() * 1e-6 << "s\tX: " << plant.GetState()[0]
+                      << "\tX_DOT: " << plant.GetState()[1] << "\tU: " << force << std::endl;
+        }
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    std::cout << "[Lockstep]: Simulated " << runner.GetSimulatedTime() * 1e-6 << "s in " << wall << "s wall time" << std::endl;
+    return 0;
+}
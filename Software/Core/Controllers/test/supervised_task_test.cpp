@@ -0,0 +1,172 @@
+#include <Realtime/RealTimeTask.hpp>
+#include <Realtime/ProcessSupervisor.hpp>
+#include <Communications/Port.hpp>
+#include <Controllers/StateEstimator.hpp>
+#include <Controllers/ConvexMPC.hpp>
+#include <Controllers/ReferenceTrajectoryGen.hpp>
+#include <OperatorInterface/RemoteTeleop.hpp>
+#include <Plotting/PlotterTaskNode.hpp>
+#include <Systems/TscClock.hpp>
+
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+// Same task set as task_node_test, split into a control process and a best effort plotting process.  Run as root
+// on a cgroup v2 system.  Control owns the upper CPUs, plotting is held to 20% of CPU 0
+namespace
+{
+// Task Periods
+const int freq1 = 50;
+const int freq2 = 100;
+
+// Horizons
+const int N = 16;
+const double T = 1.5;
+
+const std::string gazebo_url = "udpm://239.255.76.67:7667?ttl=0";
+
+int ControlGroup()
+{
+    Realtime::RealTimeTaskManager::Instance();
+    Realtime::PortManager::Instance();
+    Realtime::RealTimeTaskManager::Instance()->EnableRealtimeMemory();
+
+    std::shared_ptr<Realtime::Port> GAZEBO_IMU = std::make_shared<Realtime::Port>("GAZEBO_IMU", Realtime::Port::Direction::OUTPUT, Realtime::Port::DataType::DOUBLE, 2, 10);
+    GAZEBO_IMU->SetTransport(Realtime::Port::TransportType::UDP, gazebo_url, "nomad.imu");
+
+    // Remote Teleop Task
+    OperatorInterface::Teleop::RemoteTeleop teleop_node("Remote_Teleop");
+    teleop_node.SetStackSize(1024 * 1024); // 1MB
+    teleop_node.SetTaskPriority(Realtime::Priority::MEDIUM);
+    teleop_node.SetTaskFrequency(freq1); // 50 HZ
+    teleop_node.SetPortOutput(OperatorInterface::Teleop::RemoteTeleop::OutputPort::SETPOINT,
+                              Realtime::Port::TransportType::INPROC, "inproc", "nomad.setpoint");
+    teleop_node.Start();
+
+    // State Estimator.  IPC so the plotting process can subscribe
+    Controllers::Estimators::StateEstimator estimator_node("Estimator_Task");
+    estimator_node.SetStackSize(1024 * 1024); // 1MB
+    estimator_node.SetTaskPriority(Realtime::Priority::MEDIUM);
+    estimator_node.SetTaskFrequency(freq2); // 100 HZ
+    estimator_node.SetCoreAffinity(Realtime::RealTimeTaskNode::AUTO_AFFINITY);
+    estimator_node.SetSchedulingMode(Realtime::SchedulingMode::ABSOLUTE_HYBRID);
+    estimator_node.SetPortOutput(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT,
+                                 Realtime::Port::TransportType::IPC, "ipc", "nomad.state");
+
+    // Reference Trajectory Generator
+    Controllers::Locomotion::ReferenceTrajectoryGenerator ref_generator_node("Reference_Trajectory_Task", N, T);
+    ref_generator_node.SetStackSize(1024 * 1024); // 1MB
+    ref_generator_node.SetTaskPriority(Realtime::Priority::MEDIUM);
+    ref_generator_node.SetTaskFrequency(freq1); // 50 HZ
+    ref_generator_node.SetCoreAffinity(Realtime::RealTimeTaskNode::AUTO_AFFINITY);
+    ref_generator_node.SetPortOutput(Controllers::Locomotion::ReferenceTrajectoryGenerator::OutputPort::REFERENCE,
+                                     Realtime::Port::TransportType::INPROC, "inproc", "nomad.reference");
+    Realtime::Port::Map(ref_generator_node.GetInputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::InputPort::STATE_HAT),
+                        estimator_node.GetOutputPort(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT));
+    Realtime::Port::Map(ref_generator_node.GetInputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::InputPort::SETPOINT),
+                        teleop_node.GetOutputPort(OperatorInterface::Teleop::RemoteTeleop::OutputPort::SETPOINT));
+    ref_generator_node.SetTriggerPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::InputPort::STATE_HAT);
+    ref_generator_node.Start();
+
+    // Convex Model Predicive Controller for Locomotion
+    Controllers::Locomotion::ConvexMPC convex_mpc_node("Convex_MPC_Task", N, T);
+    convex_mpc_node.SetStackSize(8192 * 1024); // 8MB
+    convex_mpc_node.SetTaskPriority(Realtime::Priority::HIGH);
+    convex_mpc_node.SetTaskFrequency(freq1); // 50 HZ
+    convex_mpc_node.SetCoreAffinity(Realtime::RealTimeTaskNode::AUTO_AFFINITY);
+    convex_mpc_node.SetSchedulingPolicy(Realtime::SchedulingPolicy::FIFO);
+    convex_mpc_node.SetPortOutput(Controllers::Locomotion::ConvexMPC::OutputPort::FORCES, Realtime::Port::TransportType::UDP, gazebo_url, "nomad.forces");
+    Realtime::Port::Map(convex_mpc_node.GetInputPort(Controllers::Locomotion::ConvexMPC::InputPort::STATE_HAT),
+                        estimator_node.GetOutputPort(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT));
+    Realtime::Port::Map(convex_mpc_node.GetInputPort(Controllers::Locomotion::ConvexMPC::InputPort::REFERENCE_TRAJECTORY),
+                        ref_generator_node.GetOutputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::OutputPort::REFERENCE));
+    convex_mpc_node.SetTriggerPort(Controllers::Locomotion::ConvexMPC::InputPort::REFERENCE_TRAJECTORY);
+    convex_mpc_node.Start();
+
+    Realtime::Port::Map(estimator_node.GetInputPort(Controllers::Estimators::StateEstimator::InputPort::IMU), GAZEBO_IMU);
+    estimator_node.Start();
+
+    Realtime::PortManager::Instance()->GetInprocContext()->start();
+
+    Realtime::ProcessSupervisor::WaitForShutdown();
+
+    Realtime::RealTimeTaskManager::Instance()->PrintActiveTasks();
+    ref_generator_node.Stop();
+    convex_mpc_node.Stop();
+    estimator_node.Stop();
+    teleop_node.Stop();
+    usleep(100000); // Let the task loops see the stop
+    return 0;
+}
+
+int PlottingGroup()
+{
+    Realtime::RealTimeTaskManager::Instance();
+    Realtime::PortManager::Instance();
+
+    // Channels published by the control process
+    std::shared_ptr<Realtime::Port> STATE_HAT = std::make_shared<Realtime::Port>("STATE_HAT", Realtime::Port::Direction::OUTPUT, Realtime::Port::DataType::DOUBLE, -1, 1000 / freq2);
+    STATE_HAT->SetTransport(Realtime::Port::TransportType::IPC, "ipc", "nomad.state");
+    std::shared_ptr<Realtime::Port> FORCES = std::make_shared<Realtime::Port>("FORCES", Realtime::Port::Direction::OUTPUT, Realtime::Port::DataType::DOUBLE, -1, 1000 / freq1);
+    FORCES->SetTransport(Realtime::Port::TransportType::UDP, gazebo_url, "nomad.forces");
+
+    Plotting::PlotterTaskNode scope("Forces");
+    scope.SetTaskFrequency(freq1); // 50 HZ
+    scope.SetTaskPriority(Realtime::Priority::LOWEST);
+    scope.ConnectInput(Plotting::PlotterTaskNode::PORT_1, FORCES);
+    scope.AddPlotVariable(Plotting::PlotterTaskNode::PORT_1, Controllers::Locomotion::ConvexMPC::U);
+    scope.Start();
+
+    Plotting::PlotterTaskNode scope2("State");
+    scope2.SetTaskFrequency(freq1); // 50 HZ
+    scope2.SetTaskPriority(Realtime::Priority::LOWEST);
+    scope2.ConnectInput(Plotting::PlotterTaskNode::PORT_1, STATE_HAT);
+    scope2.AddPlotVariable(Plotting::PlotterTaskNode::PORT_1, Controllers::Estimators::StateEstimator::X);
+    scope2.AddPlotVariable(Plotting::PlotterTaskNode::PORT_1, Controllers::Estimators::StateEstimator::X_DOT);
+    scope2.Start();
+
+    Realtime::ProcessSupervisor::WaitForShutdown();
+
+    scope.Stop();
+    scope2.Stop();
+    usleep(100000);
+    scope.RenderPlot();
+    scope2.RenderPlot();
+    return 0;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    // One time base for both processes
+    Systems::TscClock::Instance()->ResetEpoch();
+
+    Realtime::ProcessSupervisor supervisor("nomad");
+
+    // Control tasks.  Everything but CPU 0, exclusive.  The whole stack goes down with it
+    Realtime::ProcessSupervisor::GroupConfig control;
+    control.cpus = num_cpus > 1 ? "1-" + std::to_string(num_cpus - 1) : "0";
+    control.isolated = num_cpus > 1;
+    control.critical = true;
+    supervisor.AddGroup("control", ControlGroup, control);
+
+    // Plotting.  Best effort on CPU 0, throttled to 20% and restarted if matplotlib falls over
+    Realtime::ProcessSupervisor::GroupConfig plotting;
+    plotting.cpus = "0";
+    plotting.cpu_quota_us = 20000;
+    plotting.cpu_period_us = 100000;
+    plotting.restart = Realtime::ProcessSupervisor::RESTART_ON_FAILURE;
+    plotting.max_restarts = 3;
+    supervisor.AddGroup("plotting", PlottingGroup, plotting);
+
+    if (!supervisor.Start())
+        return 1;
+    supervisor.PrintStatus();
+
+    // Until Ctrl-C or the control process exits
+    return supervisor.Run();
+}
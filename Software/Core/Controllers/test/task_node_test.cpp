@@ -1,4 +1,6 @@
 #include <Realtime/RealTimeTask.hpp>
+#include <Realtime/CyclicExecutive.hpp>
+#include <Realtime/ParameterStore.hpp>
 #include <Communications/Port.hpp>
 #include <Controllers/StateEstimator.hpp>
 #include <Controllers/ConvexMPC.hpp>
@@ -8,6 +10,7 @@
 #include <Plotting/PlotterTaskNode.hpp>
 #include <Systems/NomadPlant.hpp>
 #include <Systems/Time.hpp>
+#include <Systems/TscClock.hpp>
 
 #include <memory>
 
@@ -18,13 +21,6 @@
 int main(int argc, char *argv[])
 {
 
-    //https://rt.wiki.kernel.org/index.php/Threaded_RT-application_with_memory_locking_and_stack_handling_example
-    // if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1)
-    // {
-    //     printf("mlockall failed: %m\n");
-    //     exit(-2);
-    // }
-
     // Task Periods.
     int freq1 = 50;
     int freq2 = 100;
@@ -42,6 +38,26 @@ int main(int argc, char *argv[])
     Realtime::RealTimeTaskManager::Instance();
     Realtime::PortManager::Instance();
 
+    // Restart the shared time epoch for this run.  Gazebo and plotters attached to it stamp on the same time base
+    Systems::TscClock::Instance()->ResetEpoch();
+
+    // Lock memory and prefault heap/stacks so the control loops do not page fault
+    //https://rt.wiki.kernel.org/index.php/Threaded_RT-application_with_memory_locking_and_stack_handling_example
+    Realtime::RealTimeTaskManager::Instance()->EnableRealtimeMemory();
+
+    // Keep the cores out of deep idle states so sleeping releases wake on time
+    Realtime::RealTimeTaskManager::Instance()->EnableLowLatencyMode();
+
+    // WCETs measured by a previous run for the schedulability check at task start
+    Realtime::RealTimeTaskManager::Instance()->LoadWcetCalibration("nomad_wcet.txt");
+
+    // Stagger releases along the port graph on the shared time base.  Estimator -> Reference -> MPC as a pipeline
+    Realtime::RealTimeTaskManager::Instance()->SetReleasePhasing(true);
+    Realtime::RealTimeTaskManager::Instance()->ResetReleaseEpoch();
+
+    // Trace samples from the IMU through to nomad.forces.  Enable before tasks start so buffers are allocated up front
+    Realtime::DataflowTracer::Enable();
+
     std::shared_ptr<Realtime::Port> GAZEBO_IMU = std::make_shared<Realtime::Port>("GAZEBO_IMU", Realtime::Port::Direction::OUTPUT, Realtime::Port::DataType::DOUBLE, 2, 10);
     GAZEBO_IMU->SetTransport(Realtime::Port::TransportType::UDP, gazebo_url, "nomad.imu");
 
@@ -60,7 +76,8 @@ int main(int argc, char *argv[])
     estimator_node.SetStackSize(1024 * 1024); // 1MB
     estimator_node.SetTaskPriority(Realtime::Priority::MEDIUM);
     estimator_node.SetTaskFrequency(freq2); // 1000 HZ
-    estimator_node.SetCoreAffinity(1);
+    estimator_node.SetCoreAffinity(Realtime::RealTimeTaskNode::AUTO_AFFINITY);
+    estimator_node.SetSchedulingMode(Realtime::SchedulingMode::ABSOLUTE_HYBRID);
     estimator_node.SetPortOutput(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT,
                                  Realtime::Port::TransportType::INPROC, "inproc", "nomad.state");
 
@@ -69,7 +86,8 @@ int main(int argc, char *argv[])
     ref_generator_node.SetStackSize(1024 * 1024); // 1MB
     ref_generator_node.SetTaskPriority(Realtime::Priority::MEDIUM);
     ref_generator_node.SetTaskFrequency(freq1); // 50 HZ
-    ref_generator_node.SetCoreAffinity(-1);
+    ref_generator_node.SetCoreAffinity(Realtime::RealTimeTaskNode::AUTO_AFFINITY);
+    ref_generator_node.SetRunArena(1024 * 1024);
     ref_generator_node.SetPortOutput(Controllers::Locomotion::ReferenceTrajectoryGenerator::OutputPort::REFERENCE,
                                      Realtime::Port::TransportType::INPROC, "inproc", "nomad.reference");
 
@@ -80,6 +98,9 @@ int main(int argc, char *argv[])
     // Map Setpoint Output to Trajectory Reference Generator Input
     Realtime::Port::Map(ref_generator_node.GetInputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::InputPort::SETPOINT),
                         teleop_node.GetOutputPort(OperatorInterface::Teleop::RemoteTeleop::OutputPort::SETPOINT));
+
+    // Run as soon as a new state estimate arrives
+    ref_generator_node.SetTriggerPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::InputPort::STATE_HAT);
     ref_generator_node.Start();
 
 
@@ -88,7 +109,13 @@ int main(int argc, char *argv[])
     convex_mpc_node.SetStackSize(8192 * 1024); // 8MB
     convex_mpc_node.SetTaskPriority(Realtime::Priority::HIGH);
     convex_mpc_node.SetTaskFrequency(freq1); // 50 HZ
-    convex_mpc_node.SetCoreAffinity(2);
+    convex_mpc_node.SetCoreAffinity(Realtime::RealTimeTaskNode::AUTO_AFFINITY);
+    convex_mpc_node.SetSchedulingPolicy(Realtime::SchedulingPolicy::FIFO);
+    convex_mpc_node.SetAllocationTracking(true);  // Needs -DREALTIME_ALLOCATION_TRACKER=ON
+    convex_mpc_node.SetMemoryProfiling(true);     // Stack high water and peak heap to size the 8MB stack
+    convex_mpc_node.SetPerformanceCounters(true); // IPC and cache misses of the solve
+    convex_mpc_node.SetResourceAccounting(true);  // CPU time vs interference of the solve
+    convex_mpc_node.SetRunArena(8 * 1024 * 1024); // Condensed QP temporaries off the heap
     convex_mpc_node.SetPortOutput(Controllers::Locomotion::ConvexMPC::OutputPort::FORCES, Realtime::Port::TransportType::UDP, gazebo_url, "nomad.forces");
 
     // Map State Estimator Output to Trajectory Reference Input
@@ -99,27 +126,27 @@ int main(int argc, char *argv[])
     Realtime::Port::Map(convex_mpc_node.GetInputPort(Controllers::Locomotion::ConvexMPC::InputPort::REFERENCE_TRAJECTORY),
                         ref_generator_node.GetOutputPort(Controllers::Locomotion::ReferenceTrajectoryGenerator::OutputPort::REFERENCE));
 
+    // Run as soon as a new reference arrives
+    convex_mpc_node.SetTriggerPort(Controllers::Locomotion::ConvexMPC::InputPort::REFERENCE_TRAJECTORY);
     convex_mpc_node.Start();
 
+    // Plotters share one thread on a cyclic executive
+    Realtime::CyclicExecutive plot_executive("Plotting_Executive", Realtime::Priority::LOWEST, Realtime::RealTimeTaskNode::AUTO_AFFINITY, 8192 * 1024);
+
     // Plotter Task Node
     Plotting::PlotterTaskNode scope("Forces");
-    scope.SetStackSize(8192 * 1024);
-    scope.SetTaskPriority(Realtime::Priority::LOWEST);
     scope.SetTaskFrequency(freq1); // 50 HZ
-    scope.SetCoreAffinity(4);
     scope.ConnectInput(Plotting::PlotterTaskNode::PORT_1, convex_mpc_node.GetOutputPort(Controllers::Locomotion::ConvexMPC::OutputPort::FORCES));
     scope.AddPlotVariable(Plotting::PlotterTaskNode::PORT_1, Controllers::Locomotion::ConvexMPC::U);
-    scope.Start();
+    plot_executive.AddTask(&scope);
 
     Plotting::PlotterTaskNode scope2("State");
-    scope2.SetStackSize(8192 * 1024);
-    scope2.SetTaskPriority(Realtime::Priority::LOWEST);
     scope2.SetTaskFrequency(freq1); // 50 HZ
-    scope2.SetCoreAffinity(4);
     scope2.ConnectInput(Plotting::PlotterTaskNode::PORT_1, estimator_node.GetOutputPort(Controllers::Estimators::StateEstimator::OutputPort::STATE_HAT));
     scope2.AddPlotVariable(Plotting::PlotterTaskNode::PORT_1, Controllers::Estimators::StateEstimator::X);
     scope2.AddPlotVariable(Plotting::PlotterTaskNode::PORT_1, Controllers::Estimators::StateEstimator::X_DOT);
-    scope2.Start();
+    plot_executive.AddTask(&scope2);
+    plot_executive.Start();
 
     // Gait Scheduler
     // Controllers::Locomotion::GaitScheduler gait_scheduler_node("Gait_Scheduler_Task");
@@ -150,6 +177,11 @@ int main(int argc, char *argv[])
 
     // Print Threads
     Realtime::RealTimeTaskManager::Instance()->PrintActiveTasks();
+    Realtime::RealTimeTaskManager::Instance()->PrintReleaseOffsets();
+
+    // Tuning from a previous session, if any
+    Realtime::ParameterStore::Instance()->Load("nomad_params.txt");
+    Realtime::ParameterStore::Instance()->Print();
 
     // Start Inproc Context Process Thread
     Realtime::PortManager::Instance()->GetInprocContext()->start();
@@ -157,7 +189,14 @@ int main(int argc, char *argv[])
     // Run for 10 Seconds
     int j = 0;
     while (j < 5)
-    {    // Systems::Nomad::NomadPlant nomad("Nomad_Plant", 1.0/freq2);
+    {
+        // Retune while running.  Picked up between cycles, no restart
+        if (j == 2)
+        {
+            Realtime::ParameterStore::Instance()->Set("reference.x_target", "5.0");
+            Realtime::ParameterStore::Instance()->Set("mpc.Q", "200.0, 1.0");
+        }
+    // Systems::Nomad::NomadPlant nomad("Nomad_Plant", 1.0/freq2);
     // nomad.SetStackSize(8192 * 1024); // 8 MB
     // nomad.SetTaskPriority(Realtime::Priority::HIGH);
     // nomad.SetTaskFrequency(freq2); // 1000 HZ
@@ -166,9 +205,20 @@ int main(int argc, char *argv[])
         usleep(1e6);
         j++;
     }
+
+    // Print Task Timing Statistics
+    Realtime::RealTimeTaskManager::Instance()->PrintActiveTasks();
+
+    // Check the task set with this run's WCETs and keep them for the next run
+    Realtime::RealTimeTaskManager::Instance()->AnalyzeSchedulability();
+    Realtime::RealTimeTaskManager::Instance()->SaveWcetCalibration("nomad_wcet.txt");
+
+    // End to end latency.  Open nomad_trace.json in ui.perfetto.dev or chrome://tracing
+    Realtime::DataflowTracer::PrintSummary();
+    Realtime::DataflowTracer::WriteChromeTrace("nomad_trace.json");
+
     //nomad.Stop();
-    scope.Stop();
-    scope2.Stop();
+    plot_executive.Stop();
     ref_generator_node.Stop();
     convex_mpc_node.Stop();
     estimator_node.Stop();
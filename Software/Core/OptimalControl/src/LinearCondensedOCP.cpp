@@ -23,6 +23,7 @@
  */
 
 #include <OptimalControl/LinearCondensedOCP.hpp>
+#include <Realtime/RealTimeLog.hpp>
 #include <chrono>
 
 using namespace ControlsLibrary;
@@ -130,7 +131,7 @@ void LinearCondensedOCP::Solve()
     auto stop = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
 
-    std::cout << "Solver Time: " << duration.count() << " microseconds" << std::endl;
+    Realtime::RealTimeLog::Print("Solver Time: {} microseconds", duration.count());
 }
 
 } // namespace LinearOptimalControl
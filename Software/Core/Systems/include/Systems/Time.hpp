@@ -33,6 +33,7 @@
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <atomic>
 
 // Third Party Includes
 
@@ -40,6 +41,33 @@
 namespace Systems
 {
 
+// Time source for Time::GetTime (microseconds)
+class Clock
+{
+    public:
+        virtual ~Clock() {}
+
+        virtual uint64_t Now() = 0;
+};
+
+// Simulated time.  Only moves when set/advanced, i.e. by a lockstep runner
+class VirtualClock : public Clock
+{
+    public:
+        VirtualClock() : now_(0) {}
+
+        virtual uint64_t Now() { return now_.load(std::memory_order_acquire); }
+
+        // Set Time (microseconds)
+        void Set(const uint64_t time) { now_.store(time, std::memory_order_release); }
+
+        // Advance Time (microseconds)
+        void Advance(const uint64_t duration) { now_.fetch_add(duration, std::memory_order_acq_rel); }
+
+    protected:
+        std::atomic<uint64_t> now_;
+};
+
 class Time
 {
     public:
@@ -48,7 +76,14 @@ class Time
         Time();
         ~Time();
 
+        // Current time (microseconds) from the installed clock.  TscClock (shared epoch) by default
         static uint64_t GetTime();
+
+        // Install a clock source.  NULL restores the default clock.  The clock must outlive its use
+        static void SetClock(Clock *clock);
+
+        // Installed clock source.  NULL for the default clock
+        static Clock *GetClock();
     protected:
 
         std::chrono::time_point<std::chrono::system_clock> start_;
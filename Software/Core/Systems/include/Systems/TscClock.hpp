@@ -0,0 +1,133 @@
+/*
+ * TscClock.hpp
+ *
+ *  Created on: August 30, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_SYSTEMS_TSCCLOCK_H
+#define NOMAD_SYSTEMS_TSCCLOCK_H
+
+// C System Files
+#include <stdint.h>
+
+// C++ System Files
+#include <string>
+
+// Project Include Files
+namespace Systems
+{
+
+// Cycle counter clock with a system wide epoch.  Reads the invariant TSC (x86) or CNTVCT (ARMv8), scaled to
+// nanoseconds by a calibration against CLOCK_MONOTONIC, the clock the task releases run on.  The calibration and the
+// epoch live in shared memory, so every process on the host converts counter ticks the same way and timestamps compare
+// across processes.  The first process to attach calibrates and publishes, later processes reuse it.  A stale segment
+// left by a crashed creator is recreated.  Falls back to CLOCK_MONOTONIC when the counter is not invariant or the
+// shared memory is unavailable.
+class TscClock
+{
+    public:
+
+        // Shared Memory Name
+        static constexpr const char *SHM_NAME = "/nomad_time_epoch";
+
+        // Calibration window (microseconds)
+        static const long CALIBRATION_TIME = 20000;
+
+        // STATIC Singleton Instance.  Attaches (or calibrates) on first use
+        static TscClock *Instance();
+
+        // Nanoseconds since the shared epoch
+        inline uint64_t NowNanoseconds() const
+        {
+            const uint64_t ns = ClockNanoseconds();
+            const uint64_t epoch = *epoch_ns_;
+            return ns > epoch ? ns - epoch : 0;
+        }
+
+        // Microseconds since the shared epoch
+        inline uint64_t Now() const { return NowNanoseconds() / 1000; }
+
+        // Restart the shared epoch at the current time.  Affects every attached process.  Call once from the process
+        // that owns the run (i.e. the controller main) before others start stamping
+        void ResetEpoch();
+
+        // Counter in use.  False when running on CLOCK_MONOTONIC
+        bool IsCounterBased() const { return use_counter_; }
+
+        // Counter frequency (Hz).  0 when not counter based
+        uint64_t GetFrequency() const { return frequency_; }
+
+        // Raw counter read
+        static inline uint64_t ReadCounter()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            uint32_t low, high;
+            __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+            return ((uint64_t)high << 32) | low;
+#elif defined(__aarch64__)
+            uint64_t value;
+            __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value));
+            return value;
+#else
+            return 0;
+#endif
+        }
+
+    protected:
+
+        // Attach to or create the shared calibration
+        TscClock();
+
+        // Invariant counter present
+        static bool HasInvariantCounter();
+
+        // Measure counter frequency against CLOCK_MONOTONIC
+        static uint64_t Calibrate();
+
+        // CLOCK_MONOTONIC nanoseconds
+        static uint64_t Monotonic();
+
+        // Nanoseconds on the shared time base, before the epoch is applied
+        inline uint64_t ClockNanoseconds() const
+        {
+            return use_counter_ ? TicksToNanoseconds(ReadCounter() - tsc_base_) : Monotonic() - ns_base_;
+        }
+
+        // Fixed point tick conversion.  ns = (ticks * mult) >> SHIFT
+        inline uint64_t TicksToNanoseconds(const uint64_t ticks) const
+        {
+            return (uint64_t)(((unsigned __int128)ticks * mult_) >> SHIFT);
+        }
+
+        static const int SHIFT = 32;
+
+        // Calibration (copied from shared memory)
+        bool use_counter_;
+        uint64_t frequency_;
+        uint64_t tsc_base_;
+        uint64_t ns_base_;
+        uint64_t mult_;
+
+        // Shared epoch (nanoseconds on this clock).  Points into shared memory, or local storage on fallback
+        volatile uint64_t *epoch_ns_;
+        uint64_t local_epoch_ns_;
+};
+}
+#endif // NOMAD_SYSTEMS_TSCCLOCK_H
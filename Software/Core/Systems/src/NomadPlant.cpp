@@ -37,6 +37,7 @@
 
 // Project Includes
 #include <Realtime/RealTimeTask.hpp>
+#include <Realtime/RealTimeLog.hpp>
 
 namespace Systems
 {
@@ -129,16 +130,14 @@ void NomadPlant::Run()
     }
     else
     {
-        std::cout << "[NomadPlant]: Receive Buffer Empty!" << std::endl;
+        Realtime::RealTimeLog::Print("[NomadPlant]: Receive Buffer Empty!");
     }
 
     rigid_skel->getBodyNode(0)->addExtForce(Eigen::Vector3d::UnitX() * current_force, rigid_skel->getBodyNode(0)->getCOM(), false, true);
-    std::cout << "TIME: " << Systems::Time::GetTime() / 1e6<< std::endl;
-    std::cout << world->getTime() << " : ";
-    std::cout << "U: " << current_force << std::endl;
-    std::cout << "X: " << rigid_skel->getPosition(3) << "\tY: " << rigid_skel->getPosition(4) << "\tZ: " << rigid_skel->getPosition(5) << std::endl;
-    std::cout << "X_DOT: " << rigid_skel->getVelocity(3) << "\tY_DOT: " << rigid_skel->getVelocity(4) << "\tZ_DOT: " << rigid_skel->getVelocity(5) << std::endl;
-    std::cout << std::endl;
+    Realtime::RealTimeLog::Print("TIME: {}", Systems::Time::GetTime() / 1e6);
+    Realtime::RealTimeLog::Print("{} : U: {}", world->getTime(), current_force);
+    Realtime::RealTimeLog::Print("X: {}\tY: {}\tZ: {}", rigid_skel->getPosition(3), rigid_skel->getPosition(4), rigid_skel->getPosition(5));
+    Realtime::RealTimeLog::Print("X_DOT: {}\tY_DOT: {}\tZ_DOT: {}\n", rigid_skel->getVelocity(3), rigid_skel->getVelocity(4), rigid_skel->getVelocity(5));
 
     world->step(true);
 
@@ -34,9 +34,13 @@
 // Third Party Includes
 
 // Project Include Files
+#include <Systems/TscClock.hpp>
 
 namespace Systems
 {
+    // Installed clock source.  NULL = TscClock
+    static std::atomic<Clock *> clock_source(nullptr);
+
     Time::Time()
     {
         start_ = std::chrono::high_resolution_clock::now();
@@ -50,11 +54,24 @@ namespace Systems
     }
     uint64_t Time::GetTime()
     {
-        static auto start_time = std::chrono::high_resolution_clock::now(); 
+        Clock *clock = clock_source.load(std::memory_order_acquire);
+        if (clock != nullptr)
+        {
+            return clock->Now();
+        }
+
+        // Counter clock on the shared epoch.  Comparable across processes
+        return TscClock::Instance()->Now();
+    }
 
-        auto time_now = std::chrono::high_resolution_clock::now(); 
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(time_now - start_time); 
-        return duration.count();
+    void Time::SetClock(Clock *clock)
+    {
+        clock_source.store(clock, std::memory_order_release);
+    }
+
+    Clock *Time::GetClock()
+    {
+        return clock_source.load(std::memory_order_acquire);
     }
 
 }
\ No newline at end of file
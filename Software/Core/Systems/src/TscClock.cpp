@@ -0,0 +1,277 @@
+/*
+ * TscClock.cpp
+ *
+ *  Created on: August 30, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Primary Include
+#include <Systems/TscClock.hpp>
+
+// C System Includes
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// C++ System Includes
+#include <atomic>
+#include <iostream>
+
+namespace Systems
+{
+namespace
+{
+const uint32_t SHARED_MAGIC = 0x4E4D5432; // "NMT2"
+
+// Published once by the creating process.  epoch_ns may be reset later
+struct SharedEpoch
+{
+    uint32_t magic;
+    std::atomic<uint32_t> ready;
+    std::atomic<pid_t> creator; // Calibrating process.  0 until mapped
+    uint32_t use_counter;
+    uint64_t frequency;
+    uint64_t tsc_base;
+    uint64_t mult;
+    volatile uint64_t epoch_ns;
+};
+} // namespace
+
+TscClock *TscClock::Instance()
+{
+    // Thread safe on first use.  Never destroyed so stamps stay valid during static destruction
+    static TscClock *instance = new TscClock();
+    return instance;
+}
+
+TscClock::TscClock() : use_counter_(false),
+                       frequency_(0),
+                       tsc_base_(0),
+                       ns_base_(0),
+                       mult_(0),
+                       epoch_ns_(&local_epoch_ns_),
+                       local_epoch_ns_(0)
+{
+    SharedEpoch *shared = NULL;
+    bool creator = false;
+
+    // A stale segment (short, or never published because its creator died while calibrating) is unlinked and
+    // recreated once
+    for (int attempt = 0; attempt < 2 && shared == NULL; attempt++)
+    {
+        bool stale = false;
+        creator = false;
+
+        int fd = shm_open(SHM_NAME, O_RDWR | O_CREAT | O_EXCL, 0666);
+        if (fd >= 0)
+        {
+            creator = true;
+            fchmod(fd, 0666); // Not masked by umask.  Other users' processes attach too
+            if (ftruncate(fd, sizeof(SharedEpoch)) != 0)
+            {
+                // Do not leave a zero length segment behind.  Attaching processes would fault mapping it
+                close(fd);
+                shm_unlink(SHM_NAME);
+                break;
+            }
+        }
+        else
+        {
+            fd = shm_open(SHM_NAME, O_RDWR, 0666);
+
+            // Mapping past the end of a short segment faults (SIGBUS).  Give a creator between shm_open() and
+            // ftruncate() a moment, then treat it as stale
+            struct stat info;
+            for (int i = 0; fd >= 0 && i < 10; i++)
+            {
+                if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(SharedEpoch))
+                    break;
+
+                if (i == 9)
+                {
+                    close(fd);
+                    fd = -1;
+                    stale = true;
+                }
+                usleep(CALIBRATION_TIME / 20);
+            }
+        }
+
+        if (fd >= 0)
+        {
+            void *memory = mmap(NULL, sizeof(SharedEpoch), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (memory != MAP_FAILED)
+                shared = static_cast<SharedEpoch *>(memory);
+        }
+
+        if (shared != NULL && creator)
+        {
+            // Calibrate and publish
+            shared->creator.store(getpid());
+            shared->magic = SHARED_MAGIC;
+            shared->use_counter = HasInvariantCounter();
+            shared->frequency = shared->use_counter ? Calibrate() : 0;
+            shared->use_counter = shared->frequency > 0;
+            shared->tsc_base = shared->use_counter ? ReadCounter() : 0;
+            shared->mult = shared->use_counter ? (uint64_t)(((unsigned __int128)1000000000ULL << SHIFT) / shared->frequency) : 0;
+            shared->epoch_ns = 0;
+            shared->ready.store(1, std::memory_order_release);
+        }
+        else if (shared != NULL)
+        {
+            // Creator may still be calibrating.  Stop waiting as soon as it is gone
+            for (int i = 0; i < 100 && shared->ready.load(std::memory_order_acquire) == 0; i++)
+            {
+                const pid_t pid = shared->creator.load();
+                if (pid > 0 && kill(pid, 0) != 0 && errno == ESRCH)
+                    break;
+
+                usleep(CALIBRATION_TIME / 10);
+            }
+            if (shared->ready.load(std::memory_order_acquire) == 0 || shared->magic != SHARED_MAGIC)
+            {
+                munmap(shared, sizeof(SharedEpoch));
+                shared = NULL;
+                stale = true;
+            }
+        }
+
+        if (stale && attempt == 0)
+        {
+            std::cout << "[TscClock]: Shared epoch " << SHM_NAME << " is stale.  Recreating." << std::endl;
+            shm_unlink(SHM_NAME);
+        }
+    }
+
+    if (shared == NULL)
+    {
+        std::cout << "[TscClock]: Shared epoch " << SHM_NAME << " is unavailable.  Using a local epoch." << std::endl;
+    }
+
+    if (shared != NULL)
+    {
+        use_counter_ = shared->use_counter;
+        frequency_ = shared->frequency;
+        tsc_base_ = shared->tsc_base;
+        mult_ = shared->mult;
+        epoch_ns_ = &shared->epoch_ns;
+
+        // Start the shared time base near zero
+        if (creator)
+            ResetEpoch();
+    }
+    else
+    {
+        // Local epoch.  Timestamps are only comparable inside this process
+        use_counter_ = HasInvariantCounter();
+        frequency_ = use_counter_ ? Calibrate() : 0;
+        use_counter_ = frequency_ > 0;
+        tsc_base_ = ReadCounter();
+        mult_ = use_counter_ ? (uint64_t)(((unsigned __int128)1000000000ULL << SHIFT) / frequency_) : 0;
+        ns_base_ = Monotonic();
+    }
+
+    std::cout << "[TscClock]: " << (use_counter_ ? "Counter" : "CLOCK_MONOTONIC") << " time source.  Frequency: " << frequency_
+              << " Hz.  Epoch: " << (shared != NULL ? (creator ? "Shared (Created)" : "Shared (Attached)") : "Local") << std::endl;
+}
+
+void TscClock::ResetEpoch()
+{
+    *epoch_ns_ = ClockNanoseconds();
+}
+
+bool TscClock::HasInvariantCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // CPUID.80000007H:EDX[8] Invariant TSC.  Constant rate and runs in all C/P states
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+        return false;
+    return (edx & (1U << 8)) != 0;
+#elif defined(__aarch64__)
+    // Generic timer virtual counter is architecturally constant rate
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t TscClock::Calibrate()
+{
+#if defined(__aarch64__)
+    uint64_t frequency;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+    if (frequency > 0)
+        return frequency;
+#endif
+
+    // Bracket each counter read between clock reads and keep the tightest pair
+    uint64_t best_window = UINT64_MAX;
+    uint64_t start_ns = 0, start_ticks = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        const uint64_t before = Monotonic();
+        const uint64_t ticks = ReadCounter();
+        const uint64_t after = Monotonic();
+        if (after - before < best_window)
+        {
+            best_window = after - before;
+            start_ns = before + (after - before) / 2;
+            start_ticks = ticks;
+        }
+    }
+
+    usleep(CALIBRATION_TIME);
+
+    best_window = UINT64_MAX;
+    uint64_t end_ns = 0, end_ticks = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        const uint64_t before = Monotonic();
+        const uint64_t ticks = ReadCounter();
+        const uint64_t after = Monotonic();
+        if (after - before < best_window)
+        {
+            best_window = after - before;
+            end_ns = before + (after - before) / 2;
+            end_ticks = ticks;
+        }
+    }
+
+    if (end_ns <= start_ns || end_ticks <= start_ticks)
+        return 0;
+
+    return (uint64_t)((unsigned __int128)(end_ticks - start_ticks) * 1000000000ULL / (end_ns - start_ns));
+}
+
+uint64_t TscClock::Monotonic()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+}
@@ -0,0 +1,673 @@
+// Wake up latency benchmark (cyclictest style) for the task timing primitives.  Sweeps every combination of
+// scheduling mode, period, priority, affinity and background load, and reports the latency distribution and CPU usage
+// of the measuring thread as CSV or JSON.  Run on each target board and pick scheduling modes from the data.
+//
+//   latency_benchmark --modes delay,absolute --periods 100,1000,20000 --priorities 0,90 --loads 0,4 --format json
+//
+// Modes:
+//   delay    - RealTimeTaskNode::TaskDelay() relative busy wait (BUSY_WAIT)
+//   sleep    - RealTimeTaskNode::TaskSleep() relative clock_nanosleep
+//   absolute - RealTimeTaskNode::TaskDelayUntil() absolute release with a spin tail (ABSOLUTE_HYBRID)
+//   timerfd  - Periodic CLOCK_MONOTONIC timerfd
+//   parallel - WorkerPool::ParallelFor() round trip over the workers, dispatched at absolute releases
+//
+// Latency is the time from the requested wake up to the thread running again.  In the parallel mode it is the fork-join
+// round trip of an empty job, one index per thread, which should stay under 5us with the workers on free cores.  Real time priorities need root (or
+// CAP_SYS_NICE); without it the case runs SCHED_OTHER and the policy column says so.
+
+#include <Realtime/RealTimeTask.hpp>
+#include <Realtime/TaskStatistics.hpp>
+#include <Realtime/CpuPower.hpp>
+#include <Realtime/WorkerPool.hpp>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include <sys/utsname.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+enum BenchmarkMode
+{
+    DELAY = 0,
+    SLEEP,
+    ABSOLUTE,
+    TIMERFD,
+    PARALLEL
+};
+
+const char *MODE_NAMES[] = {"delay", "sleep", "absolute", "timerfd", "parallel"};
+
+// Unrecorded cycles at the start of each case.  Fault in the stack and warm the caches
+const int WARMUP_CYCLES = 10;
+
+// Background load working set per thread (bytes).  Larger than most L2 caches
+const size_t LOAD_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// Parallel mode slots, one cache line apart so the job does not measure false sharing
+const int SLOT_STRIDE = 64 / sizeof(int);
+
+struct Options
+{
+    std::vector<int> modes;
+    std::vector<long> periods;   // Microseconds
+    std::vector<int> priorities; // SCHED_FIFO priority.  0 = SCHED_OTHER
+    std::vector<int> cpus;       // -1 = Not pinned
+    std::vector<int> loads;      // Background load threads
+    double duration;             // Seconds per case
+    long spin_tail;              // Microseconds, absolute and parallel modes
+    int workers;                 // Worker threads, parallel mode
+    int dma_latency;             // /dev/cpu_dma_latency target (microseconds).  -1 = Off
+    bool lock_memory;
+    std::string format;
+    std::string output;
+};
+
+struct BenchmarkCase
+{
+    int mode;
+    long period_us;
+    int priority;
+    int cpu;
+    int load;
+    uint64_t cycles;
+    long spin_tail;
+    int workers;
+};
+
+struct BenchmarkResult
+{
+    BenchmarkCase test;
+    std::string policy;
+    uint64_t samples;
+    int64_t min_ns;
+    double avg_ns;
+    int64_t p99_ns;
+    int64_t p999_ns;
+    int64_t max_ns;
+    uint64_t overruns;
+    double cpu_percent;
+    uint64_t voluntary_switches;
+    uint64_t involuntary_switches;
+};
+
+// Measuring thread context
+struct MeasureContext
+{
+    BenchmarkCase test;
+    std::vector<int64_t> latencies;
+    uint64_t overruns;
+    uint64_t wall_ns;
+    Realtime::TaskStatistics::Usage start;
+    Realtime::TaskStatistics::Usage end;
+    Realtime::WorkerPool *pool;
+    std::vector<int> slots;
+    bool failed;
+};
+
+std::atomic_bool stop_load(false);
+
+inline int64_t ToNanoseconds(const struct timespec &ts)
+{
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+inline struct timespec FromNanoseconds(const int64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    return ts;
+}
+
+inline int64_t MonotonicNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ToNanoseconds(now);
+}
+
+template <typename T>
+bool ParseList(const std::string &text, std::vector<T> &values)
+{
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        char *end = NULL;
+        const long value = strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0')
+            return false;
+        values.push_back((T)value);
+    }
+    return !values.empty();
+}
+
+bool ParseModes(const std::string &text, std::vector<int> &modes)
+{
+    modes.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        const int count = sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]);
+        const int mode = std::find(MODE_NAMES, MODE_NAMES + count, item) - MODE_NAMES;
+        if (mode == count)
+            return false;
+        modes.push_back(mode);
+    }
+    return !modes.empty();
+}
+
+void PrintUsage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [options]\n"
+              << "  --modes LIST        delay,sleep,absolute,timerfd,parallel (default: all)\n"
+              << "  --periods LIST      Periods in microseconds (default: 100,250,500,1000,5000,20000)\n"
+              << "  --priorities LIST   SCHED_FIFO priorities 1-99, 0 = SCHED_OTHER (default: 90)\n"
+              << "  --cpus LIST         CPU to pin the measuring thread to, -1 = not pinned (default: -1)\n"
+              << "  --loads LIST        Background load threads (default: 0)\n"
+              << "  --duration SECONDS  Time per case (default: 1)\n"
+              << "  --spin-tail US      Spin tail of the absolute and parallel modes (default: 50)\n"
+              << "  --workers N         Worker threads of the parallel mode, pinned after the measuring CPU (default: 2)\n"
+              << "  --dma-latency US    Hold /dev/cpu_dma_latency at US during the run (default: off)\n"
+              << "  --mlock             Lock process memory\n"
+              << "  --format csv|json   Output format (default: csv)\n"
+              << "  --output FILE       Write results to FILE (default: stdout)\n";
+}
+
+bool ParseOptions(int argc, char *argv[], Options &options)
+{
+    ParseModes("delay,sleep,absolute,timerfd,parallel", options.modes);
+    ParseList("100,250,500,1000,5000,20000", options.periods);
+    ParseList("90", options.priorities);
+    ParseList("-1", options.cpus);
+    ParseList("0", options.loads);
+    options.duration = 1.0;
+    options.spin_tail = 50;
+    options.workers = 2;
+    options.dma_latency = -1;
+    options.lock_memory = false;
+    options.format = "csv";
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--mlock")
+        {
+            options.lock_memory = true;
+            continue;
+        }
+        if (arg == "--help" || i + 1 >= argc)
+            return false;
+
+        const std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--modes")
+            valid = ParseModes(value, options.modes);
+        else if (arg == "--periods")
+            valid = ParseList(value, options.periods);
+        else if (arg == "--priorities")
+            valid = ParseList(value, options.priorities);
+        else if (arg == "--cpus")
+            valid = ParseList(value, options.cpus);
+        else if (arg == "--loads")
+            valid = ParseList(value, options.loads);
+        else if (arg == "--duration")
+            valid = (options.duration = atof(value.c_str())) > 0.0;
+        else if (arg == "--spin-tail")
+            valid = (options.spin_tail = atol(value.c_str())) >= 0;
+        else if (arg == "--workers")
+            valid = (options.workers = atoi(value.c_str())) > 0;
+        else if (arg == "--dma-latency")
+            valid = (options.dma_latency = atoi(value.c_str())) >= 0;
+        else if (arg == "--format")
+            valid = (options.format = value) == "csv" || value == "json";
+        else if (arg == "--output")
+            options.output = value;
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            std::cerr << "[LatencyBenchmark]: Invalid option " << arg << " " << value << std::endl;
+            return false;
+        }
+    }
+
+    for (const long period : options.periods)
+    {
+        // TaskDelay() handles less than a second
+        if (period <= 0 || period >= 1000000)
+        {
+            std::cerr << "[LatencyBenchmark]: Period " << period << "us out of range (0, 1000000)" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Background load.  Walks a buffer larger than the caches so the measuring thread also sees cache and memory
+// interference, not just CPU contention
+void *LoadThread(void *)
+{
+    std::vector<uint8_t> buffer(LOAD_BUFFER_SIZE, 0);
+    volatile uint8_t *data = buffer.data();
+    uint8_t value = 0;
+    while (!stop_load.load(std::memory_order_relaxed))
+    {
+        for (size_t i = 0; i < LOAD_BUFFER_SIZE; i += 64)
+        {
+            data[i] = value++;
+        }
+    }
+    return NULL;
+}
+
+bool StartLoad(const int count, std::vector<pthread_t> &threads)
+{
+    const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    stop_load = false;
+    for (int i = 0; i < count; i++)
+    {
+        // Spread over the CPUs, SCHED_OTHER
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(i % num_cpus, &cpu_set);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpu_set);
+
+        pthread_t thread;
+        const int result = pthread_create(&thread, &attr, &LoadThread, NULL);
+        pthread_attr_destroy(&attr);
+        if (result != 0)
+        {
+            std::cerr << "[LatencyBenchmark]: Failed to create load thread: " << strerror(result) << std::endl;
+            return false;
+        }
+        threads.push_back(thread);
+    }
+    return true;
+}
+
+void StopLoad(std::vector<pthread_t> &threads)
+{
+    stop_load = true;
+    for (pthread_t thread : threads)
+    {
+        pthread_join(thread, NULL);
+    }
+    threads.clear();
+}
+
+// Wait for the next release in the case's mode.  Returns the wake up latency (nanoseconds).  next is the absolute
+// release of the absolute and timerfd modes
+int64_t WaitNext(MeasureContext *context, const int timer_fd, int64_t &next)
+{
+    const BenchmarkCase &test = context->test;
+    const int64_t period_ns = test.period_us * 1000LL;
+
+    switch (test.mode)
+    {
+    case DELAY:
+    {
+        const int64_t start = MonotonicNanoseconds();
+        Realtime::RealTimeTaskNode::TaskDelay(test.period_us);
+        return MonotonicNanoseconds() - start - period_ns;
+    }
+    case SLEEP:
+    {
+        const int64_t start = MonotonicNanoseconds();
+        Realtime::RealTimeTaskNode::TaskSleep(test.period_us);
+        return MonotonicNanoseconds() - start - period_ns;
+    }
+    case ABSOLUTE:
+    {
+        next += period_ns;
+        Realtime::RealTimeTaskNode::TaskDelayUntil(FromNanoseconds(next), test.spin_tail);
+        const int64_t now = MonotonicNanoseconds();
+
+        // Missed releases.  Resync like SKIP_NEXT
+        if (now - next >= period_ns)
+        {
+            context->overruns += (now - next) / period_ns;
+            next += ((now - next) / period_ns) * period_ns;
+        }
+        return now - next;
+    }
+    case PARALLEL:
+    {
+        next += period_ns;
+        Realtime::RealTimeTaskNode::TaskDelayUntil(FromNanoseconds(next), test.spin_tail);
+        if (MonotonicNanoseconds() - next >= period_ns)
+        {
+            context->overruns++;
+            next = MonotonicNanoseconds();
+        }
+
+        // Empty job, one index per thread.  Each index touches its own slot so the chunks are not optimized away
+        std::vector<int> &slots = context->slots;
+        const int64_t start = MonotonicNanoseconds();
+        context->pool->ParallelFor(0, test.workers + 1, [&slots](const int i) { slots[i * SLOT_STRIDE]++; });
+        return MonotonicNanoseconds() - start;
+    }
+    case TIMERFD:
+    {
+        uint64_t expirations = 0;
+        if (read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        {
+            context->failed = true;
+            return 0;
+        }
+        const int64_t now = MonotonicNanoseconds();
+        next += expirations * period_ns;
+        context->overruns += expirations - 1;
+        return now - next;
+    }
+    }
+    return 0;
+}
+
+void *MeasureThread(void *arg)
+{
+    MeasureContext *context = static_cast<MeasureContext *>(arg);
+    const BenchmarkCase &test = context->test;
+    const int64_t period_ns = test.period_us * 1000LL;
+
+    int timer_fd = -1;
+    int64_t next = MonotonicNanoseconds();
+    if (test.mode == TIMERFD)
+    {
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (timer_fd < 0)
+        {
+            context->failed = true;
+            return NULL;
+        }
+
+        // Periodic, absolute first expiry
+        next += period_ns;
+        struct itimerspec spec;
+        spec.it_value = FromNanoseconds(next);
+        spec.it_interval = FromNanoseconds(period_ns);
+        timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+        next -= period_ns;
+    }
+
+    for (int i = 0; i < WARMUP_CYCLES; i++)
+    {
+        WaitNext(context, timer_fd, next);
+    }
+    context->overruns = 0;
+
+    const int64_t start = MonotonicNanoseconds();
+    Realtime::TaskStatistics::ReadUsage(context->start);
+    for (uint64_t i = 0; i < test.cycles && !context->failed; i++)
+    {
+        context->latencies[i] = WaitNext(context, timer_fd, next);
+    }
+    Realtime::TaskStatistics::ReadUsage(context->end);
+    context->wall_ns = MonotonicNanoseconds() - start;
+
+    if (timer_fd >= 0)
+        close(timer_fd);
+
+    return NULL;
+}
+
+bool RunCase(const BenchmarkCase &test, BenchmarkResult &result)
+{
+    MeasureContext context;
+    context.test = test;
+    context.latencies.assign(test.cycles, 0);
+    context.overruns = 0;
+    context.wall_ns = 0;
+    context.pool = NULL;
+    context.failed = false;
+
+    // Workers at the measuring thread's priority on the CPUs after it
+    std::unique_ptr<Realtime::WorkerPool> pool;
+    if (test.mode == PARALLEL)
+    {
+        const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        pool.reset(new Realtime::WorkerPool("Benchmark", test.workers, test.priority > 0 ? 100 - test.priority : Realtime::Priority::HIGH));
+        if (test.priority == 0)
+            pool->SetSchedulingPolicy(Realtime::SchedulingPolicy::TIME_SHARING);
+        for (int i = 0; i < test.workers && test.cpu >= 0; i++)
+            pool->SetWorkerAffinity(i, (test.cpu + 1 + i) % num_cpus);
+
+        if (!pool->Start())
+        {
+            std::cerr << "[LatencyBenchmark]: Failed to start the worker pool" << std::endl;
+            return false;
+        }
+        context.pool = pool.get();
+        context.slots.assign((test.workers + 1) * SLOT_STRIDE, 0);
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (test.cpu >= 0)
+    {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(test.cpu, &cpu_set);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpu_set);
+    }
+
+    result.policy = "OTHER";
+    if (test.priority > 0)
+    {
+        struct sched_param param;
+        param.sched_priority = test.priority;
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+        result.policy = "FIFO";
+    }
+
+    pthread_t thread;
+    int status = pthread_create(&thread, &attr, &MeasureThread, &context);
+    if (status == EPERM && test.priority > 0)
+    {
+        // No real time capability.  Measure under SCHED_OTHER and say so
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        result.policy = "OTHER";
+        status = pthread_create(&thread, &attr, &MeasureThread, &context);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (status != 0)
+    {
+        std::cerr << "[LatencyBenchmark]: Failed to create measuring thread: " << strerror(status) << std::endl;
+        return false;
+    }
+    pthread_join(thread, NULL);
+
+    if (context.failed)
+    {
+        std::cerr << "[LatencyBenchmark]: " << MODE_NAMES[test.mode] << " timer failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::vector<int64_t> &latencies = context.latencies;
+    std::sort(latencies.begin(), latencies.end());
+
+    const size_t count = latencies.size();
+    int64_t total = 0;
+    for (const int64_t latency : latencies)
+        total += latency;
+
+    // Nearest rank
+    auto percentile = [&](const double p) {
+        const size_t rank = (size_t)std::max(1.0, std::ceil(p * count));
+        return latencies[std::min(rank, count) - 1];
+    };
+
+    result.test = test;
+    result.samples = count;
+    result.min_ns = latencies.front();
+    result.avg_ns = (double)total / count;
+    result.p99_ns = percentile(0.99);
+    result.p999_ns = percentile(0.999);
+    result.max_ns = latencies.back();
+    result.overruns = context.overruns;
+    result.cpu_percent = context.wall_ns ? 100.0 * (context.end.cpu_ns - context.start.cpu_ns) / context.wall_ns : 0.0;
+    result.voluntary_switches = context.end.voluntary_switches - context.start.voluntary_switches;
+    result.involuntary_switches = context.end.involuntary_switches - context.start.involuntary_switches;
+    return true;
+}
+
+void WriteCsv(std::ostream &out, const std::vector<BenchmarkResult> &results)
+{
+    out << "mode,period_us,priority,policy,cpu,load,spin_tail_us,samples,min_us,avg_us,p99_us,p999_us,max_us,overruns,"
+        << "cpu_percent,voluntary_switches,involuntary_switches\n";
+    out << std::fixed << std::setprecision(3);
+    for (const BenchmarkResult &result : results)
+    {
+        const BenchmarkCase &test = result.test;
+        out << MODE_NAMES[test.mode] << "," << test.period_us << "," << test.priority << "," << result.policy << ","
+            << test.cpu << "," << test.load << "," << (test.mode == ABSOLUTE || test.mode == PARALLEL ? test.spin_tail : 0) << "," << result.samples << ","
+            << result.min_ns / 1e3 << "," << result.avg_ns / 1e3 << "," << result.p99_ns / 1e3 << ","
+            << result.p999_ns / 1e3 << "," << result.max_ns / 1e3 << "," << result.overruns << ","
+            << result.cpu_percent << "," << result.voluntary_switches << "," << result.involuntary_switches << "\n";
+    }
+}
+
+void WriteJson(std::ostream &out, const std::vector<BenchmarkResult> &results, const Options &options)
+{
+    struct utsname host;
+    uname(&host);
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n"
+        << "  \"host\": \"" << host.nodename << "\",\n"
+        << "  \"kernel\": \"" << host.release << "\",\n"
+        << "  \"machine\": \"" << host.machine << "\",\n"
+        << "  \"cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ",\n"
+        << "  \"governor\": \"" << Realtime::CpuPower::GetGovernor(0) << "\",\n"
+        << "  \"dma_latency_us\": " << options.dma_latency << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult &result = results[i];
+        const BenchmarkCase &test = result.test;
+        out << "    {\"mode\": \"" << MODE_NAMES[test.mode] << "\", \"period_us\": " << test.period_us
+            << ", \"priority\": " << test.priority << ", \"policy\": \"" << result.policy << "\", \"cpu\": " << test.cpu
+            << ", \"load\": " << test.load << ", \"spin_tail_us\": " << (test.mode == ABSOLUTE || test.mode == PARALLEL ? test.spin_tail : 0)
+            << ", \"samples\": " << result.samples << ", \"min_us\": " << result.min_ns / 1e3
+            << ", \"avg_us\": " << result.avg_ns / 1e3 << ", \"p99_us\": " << result.p99_ns / 1e3
+            << ", \"p999_us\": " << result.p999_ns / 1e3 << ", \"max_us\": " << result.max_ns / 1e3
+            << ", \"overruns\": " << result.overruns << ", \"cpu_percent\": " << result.cpu_percent
+            << ", \"voluntary_switches\": " << result.voluntary_switches
+            << ", \"involuntary_switches\": " << result.involuntary_switches << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        std::cerr << "[LatencyBenchmark]: mlockall failed: " << strerror(errno) << std::endl;
+    }
+
+    int dma_latency_fd = -1;
+    if (options.dma_latency >= 0)
+    {
+        dma_latency_fd = Realtime::CpuPower::OpenLatencyRequest(options.dma_latency);
+        if (dma_latency_fd < 0)
+        {
+            std::cerr << "[LatencyBenchmark]: Failed to open /dev/cpu_dma_latency: " << strerror(errno) << std::endl;
+            options.dma_latency = -1;
+        }
+    }
+
+    // Progress goes to stderr so results can be piped
+    std::vector<BenchmarkResult> results;
+    for (const int load : options.loads)
+    {
+        std::vector<pthread_t> load_threads;
+        if (!StartLoad(load, load_threads))
+        {
+            StopLoad(load_threads);
+            continue;
+        }
+
+        for (const int mode : options.modes)
+            for (const long period : options.periods)
+                for (const int priority : options.priorities)
+                    for (const int cpu : options.cpus)
+                    {
+                        BenchmarkCase test;
+                        test.mode = mode;
+                        test.period_us = period;
+                        test.priority = priority;
+                        test.cpu = cpu;
+                        test.load = load;
+                        test.cycles = std::max<uint64_t>(100, options.duration * 1e6 / period);
+                        test.spin_tail = options.spin_tail;
+                        test.workers = options.workers;
+
+                        std::cerr << "[LatencyBenchmark]: " << MODE_NAMES[mode] << "\tPeriod: " << period << "us\tPriority: "
+                                  << priority << "\tCPU: " << cpu << "\tLoad: " << load << "\tCycles: " << test.cycles << std::endl;
+
+                        BenchmarkResult result;
+                        if (RunCase(test, result))
+                            results.push_back(result);
+                    }
+
+        StopLoad(load_threads);
+    }
+
+    if (dma_latency_fd >= 0)
+        close(dma_latency_fd);
+
+    std::ofstream file;
+    if (!options.output.empty())
+    {
+        file.open(options.output);
+        if (!file)
+        {
+            std::cerr << "[LatencyBenchmark]: Failed to open " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = options.output.empty() ? std::cout : file;
+
+    if (options.format == "json")
+        WriteJson(out, results, options);
+    else
+        WriteCsv(out, results);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * AllocationTracker.hpp
+ *
+ *  Created on: August 14, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_ALLOCATIONTRACKER_H_
+#define NOMAD_REALTIME_ALLOCATIONTRACKER_H_
+
+// C Includes
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ Includes
+#include <atomic>
+
+namespace Realtime
+{
+// Per thread heap allocation tracker.  Counts malloc/free (and therefore operator new/delete) calls made by a thread
+// between Begin() and End().  Requires the library built with REALTIME_ALLOCATION_TRACKER, which interposes the
+// malloc family.  Without it the tracker is a no-op and IsAvailable() returns false.
+class AllocationTracker
+{
+
+public:
+    enum Flags
+    {
+        NONE = 0,
+        BACKTRACE = 1, // Print a backtrace for the first allocations made while tracking
+        STRICT = 2     // Abort on any allocation made while tracking
+    };
+
+    struct Counters
+    {
+        uint64_t allocations; // malloc/calloc/realloc/memalign calls
+        uint64_t frees;       // free calls
+        uint64_t bytes;       // Bytes requested
+    };
+
+    // Live heap of a thread.  Written by the owning thread only
+    struct HeapUsage
+    {
+        std::atomic<int64_t> current_bytes; // Usable bytes allocated and not yet freed
+        std::atomic<int64_t> peak_bytes;    // High water of current_bytes
+    };
+
+    // True if the malloc hooks are compiled in
+    static bool IsAvailable();
+
+    // Account the calling thread's live heap into usage until EndHeapProfile().  Counts blocks by their usable size,
+    // inside and outside Run().  Blocks handed to and freed by another thread stay counted here
+    static void BeginHeapProfile(HeapUsage *usage);
+
+    // Stop heap accounting for the calling thread
+    static void EndHeapProfile();
+
+    // Start counting allocations of the calling thread.  name is used in reports and must outlive the tracking
+    static void Begin(const char *name, int flags = Flags::NONE);
+
+    // Stop counting.  Returns the counts since Begin()
+    static Counters End();
+
+    // Maximum number of backtraces printed per thread
+    static const int MAX_REPORTS = 8;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_ALLOCATIONTRACKER_H_
@@ -0,0 +1,61 @@
+/*
+ * CpuPower.hpp
+ *
+ *  Created on: September 3, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef NOMAD_REALTIME_CPUPOWER_H_
+#define NOMAD_REALTIME_CPUPOWER_H_
+
+// C++ Includes
+#include <string>
+#include <vector>
+
+namespace Realtime
+{
+// CPU power state controls.  cpufreq governor, cpuidle states from sysfs and the /dev/cpu_dma_latency PM QoS request.
+// Writes need root (or write access to the files)
+class CpuPower
+{
+
+public:
+    struct IdleState
+    {
+        int index;        // stateN
+        std::string name; // i.e. "POLL", "C1", "C6"
+        long latency_us;  // Exit latency
+        bool disabled;    // Disabled for this CPU
+    };
+
+    // cpufreq scaling governor of a CPU.  Empty without cpufreq
+    static std::string GetGovernor(const int cpu, const std::string &sysfs_root = "/sys/devices/system/cpu");
+
+    // cpuidle states of a CPU, shallowest first.  Empty without cpuidle
+    static std::vector<IdleState> GetIdleStates(const int cpu, const std::string &sysfs_root = "/sys/devices/system/cpu");
+
+    // Enable or disable one idle state on one CPU
+    static bool SetIdleStateDisabled(const int cpu, const int index, const bool disabled, const std::string &sysfs_root = "/sys/devices/system/cpu");
+
+    // Open a system wide PM QoS request capping the wakeup latency.  The request holds while the fd stays open.
+    // Returns the fd or -1
+    static int OpenLatencyRequest(const int latency_us);
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_CPUPOWER_H_
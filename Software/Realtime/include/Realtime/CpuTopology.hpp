@@ -0,0 +1,90 @@
+/*
+ * CpuTopology.hpp
+ *
+ *  Created on: August 16, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_CPUTOPOLOGY_H_
+#define NOMAD_REALTIME_CPUTOPOLOGY_H_
+
+// C Includes
+#include <sched.h>
+
+// C++ Includes
+#include <string>
+#include <vector>
+
+namespace Realtime
+{
+// CPU topology read from sysfs.  Online CPUs, their physical cores/SMT siblings and the isolcpus/nohz_full sets
+class CpuTopology
+{
+
+public:
+    struct CPUInfo
+    {
+        int cpu;                   // Logical CPU ID
+        int core_id;               // Physical core ID within the package
+        int package_id;            // Physical package (socket) ID
+        std::vector<int> siblings; // SMT siblings including this CPU
+        bool isolated;             // In isolcpus
+        bool nohz_full;            // In nohz_full
+    };
+
+    CpuTopology();
+
+    // Read the topology.  sysfs_root = CPU sysfs directory
+    bool Load(const std::string &sysfs_root = "/sys/devices/system/cpu");
+
+    // Online CPUs
+    const std::vector<CPUInfo> &GetCPUs() const { return cpus_; }
+
+    // CPU info for a logical CPU.  NULL if offline
+    const CPUInfo *GetCPU(const int cpu) const;
+
+    // Physical core key for a logical CPU (lowest SMT sibling ID).  -1 if offline
+    int GetPhysicalCore(const int cpu) const;
+
+    // CPU set of all online CPUs that are not isolated
+    void GetHousekeepingSet(cpu_set_t &cpu_set) const;
+
+    // True if any CPU is isolated
+    bool HasIsolatedCPUs() const;
+
+    // Print the topology
+    void Print() const;
+
+    // Format a CPU set as a list, i.e. "0 1 2 3"
+    static std::string FormatCPUSet(const cpu_set_t &cpu_set);
+
+    // Parse a sysfs CPU list, i.e. "0-3,6"
+    static std::vector<int> ParseCPUList(const std::string &list);
+
+protected:
+
+    // Read a whole sysfs file.  Empty if missing
+    static std::string ReadFile(const std::string &path);
+
+    // Online CPUs
+    std::vector<CPUInfo> cpus_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_CPUTOPOLOGY_H_
@@ -0,0 +1,109 @@
+/*
+ * CyclicExecutive.hpp
+ *
+ *  Created on: August 19, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_CYCLICEXECUTIVE_H_
+#define NOMAD_REALTIME_CYCLICEXECUTIVE_H_
+
+// C Includes
+#include <limits.h>
+#include <pthread.h>
+
+// C++ Includes
+#include <string>
+#include <vector>
+
+// Project Includes
+#include <Realtime/RealTimeTask.hpp>
+
+namespace Realtime
+{
+// Rate monotonic cyclic executive.  Hosts several task nodes on a single thread.  The executive runs at the minor
+// frame (GCD of the hosted periods) and calls each hosted Run() every (period / minor frame) frames, producers before
+// consumers as given by the port connections.  The schedule repeats every major frame (LCM of the hosted periods).
+class CyclicExecutive : public RealTimeTaskNode
+{
+
+public:
+    // Cyclic Executive Task Node
+    // name = Task Name
+    // rt_priority = Executive Thread Priority -> Priority::MEDIUM,
+    // rt_core_id = CPU Core to pin the executive.  -1 for no affinity
+    // stack_size = Executive Thread Stack Size.  Must cover the largest hosted task
+    CyclicExecutive(const std::string &name,
+                    const unsigned int rt_priority = Priority::MEDIUM,
+                    const int rt_core_id = -1,
+                    const unsigned int stack_size = PTHREAD_STACK_MIN);
+
+    // Host a task node on the executive thread.  Must be called before Start().  The hosted node is not started itself
+    bool AddTask(RealTimeTaskNode *task);
+
+    // Start the executive thread.  Refuses (EINVAL) with no hosted tasks
+    int Start(void *task_param = NULL);
+
+    // Minor Frame (microseconds)
+    long GetMinorFrame() const { return minor_frame_; }
+
+    // Major Frame (microseconds)
+    long GetMajorFrame() const { return major_frame_; }
+
+    // Print the frame schedule
+    void PrintSchedule() const;
+
+protected:
+    // Overriden Run Function.  One minor frame
+    virtual void Run();
+
+    // Setup all hosted tasks and order them by their port connections
+    virtual void Setup();
+
+    // Called after each hosted Run()
+    virtual void OnTaskComplete(RealTimeTaskNode *task) {}
+
+    // Recompute minor/major frames from the hosted periods
+    void ComputeFrames();
+
+    // Order hosted tasks producers first.  Ties and cycles keep insertion order
+    void SortByDependency();
+
+    // Hosted task and its rate in minor frames
+    struct Entry
+    {
+        RealTimeTaskNode *task;
+        long divisor;
+    };
+
+    // Hosted Tasks
+    std::vector<Entry> tasks_;
+
+    // Minor Frame (microseconds)
+    long minor_frame_;
+
+    // Major Frame (microseconds)
+    long major_frame_;
+
+    // Current minor frame in the major frame
+    long frame_index_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_CYCLICEXECUTIVE_H_
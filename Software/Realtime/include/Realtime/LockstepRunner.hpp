@@ -0,0 +1,77 @@
+/*
+ * LockstepRunner.hpp
+ *
+ *  Created on: August 21, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_LOCKSTEPRUNNER_H_
+#define NOMAD_REALTIME_LOCKSTEPRUNNER_H_
+
+// C++ Includes
+#include <string>
+
+// Project Includes
+#include <Realtime/CyclicExecutive.hpp>
+#include <Systems/Time.hpp>
+
+namespace Realtime
+{
+// Deterministic lockstep runner.  Steps hosted task nodes in dependency order on simulated time, as fast as the CPU
+// allows.  Systems::Time::GetTime (and so port timestamps) follows the simulated clock while initialized.  INPROC
+// messages are flushed after every hosted Run() so each consumer sees its producer's output in the same frame.
+// Do not Start() the runner or its hosted tasks, and do not start() the INPROC context.  See
+// Core/Controllers/test/lockstep_test.cpp.
+class LockstepRunner : public CyclicExecutive
+{
+
+public:
+    // Lockstep Runner
+    // name = Runner Name
+    LockstepRunner(const std::string &name);
+
+    ~LockstepRunner();
+
+    // Setup hosted tasks and install the simulated clock.  False if there are no tasks to run or a hosted input port is
+    // not INPROC.  Hosted outputs on other transports are allowed with a warning
+    bool Initialize();
+
+    // Step one minor frame.  Initializes on first use.  False if not initialized
+    bool Step();
+
+    // Step until duration (microseconds) of simulated time has passed.  Returns number of frames stepped, 0 if not
+    // initialized
+    uint64_t RunFor(const uint64_t duration);
+
+    // Simulated Time (microseconds)
+    uint64_t GetSimulatedTime() { return clock_.Now(); }
+
+protected:
+    // Deliver pending INPROC messages
+    virtual void OnTaskComplete(RealTimeTaskNode *task);
+
+    // Simulated Clock
+    Systems::VirtualClock clock_;
+
+    // Initialized
+    bool initialized_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_LOCKSTEPRUNNER_H_
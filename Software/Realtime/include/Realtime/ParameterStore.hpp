@@ -0,0 +1,339 @@
+/*
+ * ParameterStore.hpp
+ *
+ *  Created on: September 5, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef NOMAD_REALTIME_PARAMETERSTORE_H_
+#define NOMAD_REALTIME_PARAMETERSTORE_H_
+
+// C Includes
+#include <stdint.h>
+
+// C++ Includes
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Realtime
+{
+// Typed handle to a declared parameter.  Cheap to copy, resolve names once at construction
+template <typename T>
+class Parameter
+{
+    friend class ParameterStore;
+
+public:
+    Parameter() : index_(-1) {}
+
+    bool IsValid() const { return index_ >= 0; }
+
+    int GetIndex() const { return index_; }
+
+protected:
+    explicit Parameter(const int index) : index_(index) {}
+
+    int index_;
+};
+
+// Live tunable parameters.  Values live in an immutable snapshot.  An update copies the current snapshot, changes it
+// and publishes the copy with one pointer swap (read-copy-update), so readers never lock or wait.  A reader announces
+// the epoch it entered in a per thread slot for the life of a ReadGuard, and a replaced snapshot is freed once no reader
+// entered before it was replaced.  Updates come from non real time threads (tooling, a parameter file, the console) and
+// serialize on a mutex.
+//
+// Tasks use RealTimeTaskNode::OnParameterChange() to rebuild derived state (weight matrices, buffers) on their own
+// thread between cycles, outside Run().
+class ParameterStore
+{
+
+public:
+    enum Type
+    {
+        DOUBLE = 0,
+        INTEGER,
+        BOOLEAN,
+        VECTOR
+    };
+
+    // One parameter value
+    struct Value
+    {
+        Type type;
+        double number;
+        int64_t integer;
+        bool flag;
+        std::vector<double> vector;
+        uint64_t version; // Store version of the last change
+    };
+
+    // Immutable parameter set
+    struct Snapshot
+    {
+        uint64_t version;
+        std::vector<Value> values;
+    };
+
+    // Wait free read access to the current snapshot for the guard's scope.  Nests.  Keep it short, a guard held across
+    // a sleep holds back reclamation of every later snapshot
+    class ReadGuard
+    {
+    public:
+        ReadGuard();
+        ~ReadGuard();
+
+        template <typename T>
+        const T &Get(const Parameter<T> &parameter) const;
+
+        // Store version of the last change to a parameter
+        uint64_t GetChangeVersion(const int index) const { return snapshot_->values[index].version; }
+
+        // Snapshot version
+        uint64_t GetVersion() const { return snapshot_->version; }
+
+    private:
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+        const Snapshot *snapshot_;
+    };
+
+    // Concurrent reader threads.  Registering one more aborts
+    static const int MAX_READERS = 64;
+
+    // STATIC Singleton Instance
+    static ParameterStore *Instance();
+
+    // Declare a parameter with its default.  Returns the existing parameter if the name is taken with the same type,
+    // warning if the first declaration had another default, and an invalid handle if the type differs.  Not real time
+    // safe
+    template <typename T>
+    Parameter<T> Declare(const std::string &name, const T &value);
+
+    // Find a declared parameter.  Invalid if missing or of another type
+    template <typename T>
+    Parameter<T> Find(const std::string &name) const;
+
+    // Publish a new value.  Not real time safe
+    template <typename T>
+    bool Set(const Parameter<T> &parameter, const T &value);
+
+    // Publish a value given as text (i.e. "100.0", "true", "100,1").  Vectors are comma separated
+    bool Set(const std::string &name, const std::string &value);
+
+    // Apply "name value" lines from a file in one update.  '#' starts a comment
+    bool Load(const std::string &path);
+
+    // Call a function on the updating thread after a parameter changes.  For non real time listeners (logging,
+    // persistence).  Task state is updated with RealTimeTaskNode::OnParameterChange() instead
+    void AddHook(const std::string &name, const std::function<void(const std::string &name)> &hook);
+
+    // Current store version.  One load, changes on every update
+    uint64_t GetVersion() const { return version_.load(std::memory_order_acquire); }
+
+    // Register the calling thread as a reader.  Claims a slot without allocating.  Called on the first ReadGuard of
+    // a thread; task threads register before Setup().  Aborts when all MAX_READERS slots are taken
+    static void RegisterThread();
+
+    // Release the calling thread's reader slot.  Done automatically at thread exit
+    static void UnregisterThread();
+
+    // Print every parameter and its value
+    void Print() const;
+
+protected:
+    // Per thread reader state.  Entry epoch, 0 when outside a guard
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64_t> epoch;
+        std::atomic_bool in_use;
+    };
+
+    ParameterStore();
+
+    // Copy of the current snapshot for an update.  Caller holds write_mutex_
+    Snapshot *CopyCurrent() const;
+
+    // Swap in a new snapshot, retire the old one and run hooks for the changed names.  Caller holds write_mutex_
+    void Publish(Snapshot *snapshot, const std::vector<std::string> &changed, std::unique_lock<std::mutex> &lck);
+
+    // Free retired snapshots no reader can still see.  Caller holds write_mutex_
+    void Reclaim();
+
+    // Parse text into a value of the parameter's type
+    static bool Parse(const std::string &text, Value &value);
+
+    // Format a value as text
+    static std::string Format(const Value &value);
+
+    // Report a second declaration of name whose default differs from the first
+    static void WarnDefault(const std::string &name, const Value &first, const Value &declared);
+
+    // Enter/leave a read side section on the calling thread
+    const Snapshot *Enter();
+    void Leave();
+
+    // Current snapshot
+    std::atomic<Snapshot *> current_;
+
+    // Store version.  Bumped after each publish
+    std::atomic<uint64_t> version_;
+
+    // Reclamation epoch.  Bumped after each publish.  Starts at 1, 0 marks a quiescent reader
+    std::atomic<uint64_t> epoch_;
+
+    // Reader slots
+    ReaderSlot readers_[MAX_READERS];
+
+    // Replaced snapshots and the epoch they were replaced at
+    std::vector<std::pair<Snapshot *, uint64_t>> retired_;
+
+    // Names.  Updated under write_mutex_
+    std::map<std::string, int> names_;
+
+    // Defaults of the first declaration by parameter index.  Updated under write_mutex_
+    std::vector<Value> defaults_;
+
+    // Writer hooks by parameter index
+    std::multimap<int, std::function<void(const std::string &)>> hooks_;
+
+    // Serializes updates
+    mutable std::mutex write_mutex_;
+
+    friend class ReadGuard;
+};
+
+// Value access by type
+template <typename T>
+struct ParameterTraits;
+
+template <>
+struct ParameterTraits<double>
+{
+    static const ParameterStore::Type type = ParameterStore::DOUBLE;
+    static const double &Get(const ParameterStore::Value &value) { return value.number; }
+    static void Set(ParameterStore::Value &value, const double &x) { value.number = x; }
+};
+
+template <>
+struct ParameterTraits<int64_t>
+{
+    static const ParameterStore::Type type = ParameterStore::INTEGER;
+    static const int64_t &Get(const ParameterStore::Value &value) { return value.integer; }
+    static void Set(ParameterStore::Value &value, const int64_t &x) { value.integer = x; }
+};
+
+template <>
+struct ParameterTraits<bool>
+{
+    static const ParameterStore::Type type = ParameterStore::BOOLEAN;
+    static const bool &Get(const ParameterStore::Value &value) { return value.flag; }
+    static void Set(ParameterStore::Value &value, const bool &x) { value.flag = x; }
+};
+
+template <>
+struct ParameterTraits<std::vector<double>>
+{
+    static const ParameterStore::Type type = ParameterStore::VECTOR;
+    static const std::vector<double> &Get(const ParameterStore::Value &value) { return value.vector; }
+    static void Set(ParameterStore::Value &value, const std::vector<double> &x) { value.vector = x; }
+};
+
+template <typename T>
+const T &ParameterStore::ReadGuard::Get(const Parameter<T> &parameter) const
+{
+    return ParameterTraits<T>::Get(snapshot_->values[parameter.index_]);
+}
+
+template <typename T>
+Parameter<T> ParameterStore::Declare(const std::string &name, const T &value)
+{
+    std::unique_lock<std::mutex> lck(write_mutex_);
+    auto it = names_.find(name);
+    Value entry;
+    entry.type = ParameterTraits<T>::type;
+    entry.number = 0.0;
+    entry.integer = 0;
+    entry.flag = false;
+    entry.version = 0;
+    ParameterTraits<T>::Set(entry, value);
+
+    if (it != names_.end())
+    {
+        const Value &first = defaults_[it->second];
+        if (first.type != ParameterTraits<T>::type)
+            return Parameter<T>();
+
+        // Shared by several declarers.  The first default stands
+        if (!(ParameterTraits<T>::Get(first) == value))
+            WarnDefault(name, first, entry);
+        return Parameter<T>(it->second);
+    }
+
+    Snapshot *snapshot = CopyCurrent();
+    entry.version = snapshot->version;
+    snapshot->values.push_back(entry);
+    defaults_.push_back(entry);
+
+    const int index = snapshot->values.size() - 1;
+    names_[name] = index;
+    Publish(snapshot, std::vector<std::string>(), lck);
+    return Parameter<T>(index);
+}
+
+template <typename T>
+Parameter<T> ParameterStore::Find(const std::string &name) const
+{
+    std::unique_lock<std::mutex> lck(write_mutex_);
+    auto it = names_.find(name);
+    if (it == names_.end())
+        return Parameter<T>();
+
+    const Snapshot *snapshot = current_.load(std::memory_order_acquire);
+    return snapshot->values[it->second].type == ParameterTraits<T>::type ? Parameter<T>(it->second) : Parameter<T>();
+}
+
+template <typename T>
+bool ParameterStore::Set(const Parameter<T> &parameter, const T &value)
+{
+    if (!parameter.IsValid())
+        return false;
+
+    std::unique_lock<std::mutex> lck(write_mutex_);
+    Snapshot *snapshot = CopyCurrent();
+    Value &entry = snapshot->values[parameter.index_];
+    ParameterTraits<T>::Set(entry, value);
+    entry.version = snapshot->version;
+
+    std::vector<std::string> changed;
+    for (const auto &name : names_)
+    {
+        if (name.second == parameter.index_)
+            changed.push_back(name.first);
+    }
+    Publish(snapshot, changed, lck);
+    return true;
+}
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_PARAMETERSTORE_H_
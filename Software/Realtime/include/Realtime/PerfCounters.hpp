@@ -0,0 +1,142 @@
+/*
+ * PerfCounters.hpp
+ *
+ *  Created on: September 6, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef NOMAD_REALTIME_PERFCOUNTERS_H_
+#define NOMAD_REALTIME_PERFCOUNTERS_H_
+
+// C Includes
+#include <stdint.h>
+
+// C++ Includes
+#include <atomic>
+
+namespace Realtime
+{
+// perf_event_open counter group for one thread, read around each Run().  Hardware counters (cycles, instructions,
+// cache references/misses, branches/misses) and software counters (task clock, context switches, migrations, page
+// faults) share one group, so a sample is a single read() and every counter covers the same window.  Without a PMU
+// (most VMs) or with perf_event_paranoid too high, the group falls back to the software counters.  Hardware counters
+// count user space only so they open at perf_event_paranoid 2; software counters need kernel counting and are skipped
+// above 1 without CAP_PERFMON/root.
+class PerfCounters
+{
+
+public:
+    enum Counter
+    {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        CACHE_REFERENCES,
+        CACHE_MISSES,
+        BRANCHES,
+        BRANCH_MISSES,
+        TASK_CLOCK,
+        CONTEXT_SWITCHES,
+        CPU_MIGRATIONS,
+        PAGE_FAULTS,
+        NUM_COUNTERS
+    };
+
+    // Raw group read
+    struct Sample
+    {
+        uint64_t values[NUM_COUNTERS];
+        uint64_t time_enabled;
+        uint64_t time_running;
+    };
+
+    // Plain copy of the aggregated counts for readers
+    struct Snapshot
+    {
+        uint64_t samples;             // Recorded Run() windows
+        uint64_t multiplexed_samples; // Windows the group was not on the PMU the whole time
+        uint64_t totals[NUM_COUNTERS];
+        uint64_t max[NUM_COUNTERS];   // Worst single window
+        bool available[NUM_COUNTERS];
+
+        // Instructions per cycle
+        double IPC() const { return totals[CYCLES] ? (double)totals[INSTRUCTIONS] / totals[CYCLES] : 0.0; }
+
+        // Cache misses per cache reference
+        double CacheMissRate() const { return totals[CACHE_REFERENCES] ? (double)totals[CACHE_MISSES] / totals[CACHE_REFERENCES] : 0.0; }
+
+        // Branch misses per branch
+        double BranchMissRate() const { return totals[BRANCHES] ? (double)totals[BRANCH_MISSES] / totals[BRANCHES] : 0.0; }
+
+        // Mean of a counter per Run()
+        double Mean(const Counter counter) const { return samples ? (double)totals[counter] / samples : 0.0; }
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    // Open the group on the calling thread.  False if no counter could be opened
+    bool Open();
+
+    // Close the group
+    void Close();
+
+    // Group open
+    bool IsOpen() const { return leader_fd_ >= 0; }
+
+    // Hardware counters in the group
+    bool HasHardware() const { return available_[CYCLES]; }
+
+    // Counter opened
+    bool IsAvailable(const Counter counter) const { return available_[counter]; }
+
+    // Read the group.  One system call
+    bool Read(Sample &sample) const;
+
+    // Add the counts between two samples.  Single writer (the task thread) only.  Lock free
+    void Record(const Sample &start, const Sample &end);
+
+    // Clear the aggregated counts
+    void Reset();
+
+    // Copy out the aggregated counts.  Safe to call from any thread
+    void GetSnapshot(Snapshot &snapshot) const;
+
+    // Counter name
+    static const char *Name(const Counter counter);
+
+protected:
+    // Open one event into the group.  First opened event leads
+    bool OpenCounter(const Counter counter, const uint32_t type, const uint64_t config, const bool user_only);
+
+    // Group leader.  -1 when closed
+    int leader_fd_;
+
+    // Event fds and ids by counter.  -1/0 if unavailable
+    int fds_[NUM_COUNTERS];
+    uint64_t ids_[NUM_COUNTERS];
+    bool available_[NUM_COUNTERS];
+
+    // Aggregates.  Written by the task thread only
+    std::atomic<uint64_t> samples_;
+    std::atomic<uint64_t> multiplexed_samples_;
+    std::atomic<uint64_t> totals_[NUM_COUNTERS];
+    std::atomic<uint64_t> max_[NUM_COUNTERS];
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_PERFCOUNTERS_H_
@@ -0,0 +1,161 @@
+/*
+ * ProcessSupervisor.hpp
+ *
+ *  Created on: September 4, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef NOMAD_REALTIME_PROCESSSUPERVISOR_H_
+#define NOMAD_REALTIME_PROCESSSUPERVISOR_H_
+
+// C Includes
+#include <stdint.h>
+#include <sys/types.h>
+
+// C++ Includes
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Realtime
+{
+// Runs groups of task nodes as separate processes, each in its own cgroup v2 cgroup with a cpuset and CPU limits.  A
+// crashing or misbehaving best effort group (plotting, rendering, simulation) then cannot take down the control tasks,
+// share their allocator or signal handlers, or run on their cores, and its CPU use is throttled by the kernel.  Groups
+// talk through Port transports that cross processes (IPC or UDP).  All processes share the TscClock epoch, so release
+// phasing and trace timestamps line up across groups.
+//
+// The supervising process only forks and watches.  Create no tasks or ports in it and call Start() before it starts
+// any threads.  Group cgroups are created next to each other under cgroup_root as <name>.<group>, so isolated
+// partitions sit directly below a partition root.  Pass a delegated subtree as cgroup_root when running under systemd.
+class ProcessSupervisor
+{
+
+public:
+    // What to do when a group's process exits
+    enum RestartPolicy
+    {
+        RESTART_NEVER = 0, // Leave it stopped
+        RESTART_ON_FAILURE, // Restart on a non zero exit or a signal
+        RESTART_ALWAYS      // Restart on any exit
+    };
+
+    // Process group configuration
+    struct GroupConfig
+    {
+        GroupConfig();
+
+        std::string cpus;         // cpuset.cpus (i.e. "2-3").  Empty = all CPUs of the parent
+        std::string mems;         // cpuset.mems.  Empty = all memory nodes of the parent
+        bool isolated;            // Exclusive cpuset partition without load balancing (cpuset.cpus.partition = isolated)
+        long cpu_quota_us;        // cpu.max quota per period.  <= 0 = unlimited.  Applies to SCHED_OTHER threads only
+        long cpu_period_us;       // cpu.max period
+        int cpu_weight;           // cpu.weight [1, 10000].  0 = default (100)
+        RestartPolicy restart;    // Restart policy -> RESTART_NEVER
+        int max_restarts;         // Restarts before giving up.  -1 = unlimited
+        long restart_delay_ms;    // Delay before a restart
+        bool critical;            // Shut every group down if this one exits
+    };
+
+    // Process Supervisor
+    // name = Supervisor Name.  Prefix of the group cgroups
+    // cgroup_root = cgroup v2 directory the group cgroups are created in
+    ProcessSupervisor(const std::string &name, const std::string &cgroup_root = "/sys/fs/cgroup");
+
+    ~ProcessSupervisor();
+
+    // Add a group that runs a function in a forked process.  The function sets up and starts its task nodes, calls
+    // WaitForShutdown(), stops them and returns the exit code
+    bool AddGroup(const std::string &name, const std::function<int()> &entry, const GroupConfig &config = GroupConfig());
+
+    // Add a group that runs an executable.  argv[0] is looked up in PATH
+    bool AddGroup(const std::string &name, const std::vector<std::string> &argv, const GroupConfig &config = GroupConfig());
+
+    // Create the cgroups and launch every group
+    bool Start();
+
+    // Supervise until every group has exited for good, a critical group exits, or SIGINT/SIGTERM arrives.  Returns 0
+    // if every group exited cleanly
+    int Run();
+
+    // Stop every group (SIGTERM, then SIGKILL after the timeout) and remove the cgroups
+    void Stop();
+
+    // Grace period (milliseconds) between SIGTERM and SIGKILL in Stop() -> 2000
+    void SetStopTimeout(const long timeout_ms) { stop_timeout_ms_ = timeout_ms; }
+
+    // Print group state, effective cpuset and CPU usage/throttling from cpu.stat
+    void PrintStatus() const;
+
+    // Block the calling thread until SIGINT or SIGTERM.  Groups started by the supervisor have both signals blocked
+    // before their entry function runs, so every thread it creates leaves them to this call.  Elsewhere call it (or
+    // block the signals) before creating threads
+    static int WaitForShutdown();
+
+    // Cgroups in use.  False without cgroup v2 or permission, groups then run as plain processes
+    bool HasCgroups() const { return cgroups_enabled_; }
+
+protected:
+    struct Group
+    {
+        std::string name;
+        std::function<int()> entry;
+        std::vector<std::string> argv;
+        GroupConfig config;
+        std::string cgroup_path;
+        pid_t pid;
+        int restarts;
+        uint64_t restart_at_ns; // CLOCK_MONOTONIC.  0 = No restart pending
+        int exit_status;        // Last waitpid() status
+    };
+
+    // Create the cgroup of a group and apply its limits
+    bool SetupCgroup(Group &group);
+
+    // Remove the cgroups of stopped groups
+    void RemoveCgroups();
+
+    // Fork a group's process
+    bool Launch(Group &group);
+
+    // Child side of Launch().  Does not return
+    void RunChild(Group &group);
+
+    // Collect exited processes and schedule restarts.  False if a critical group exited
+    bool Reap();
+
+    // Supervisor Name
+    std::string name_;
+
+    // cgroup v2 mount (or delegated subtree)
+    std::string cgroup_root_;
+    bool cgroups_enabled_;
+
+    // Process groups
+    std::vector<Group> groups_;
+
+    // Supervisor PID.  Children exit if it is gone before they set up their death signal
+    pid_t supervisor_pid_;
+
+    long stop_timeout_ms_;
+    bool started_;
+    bool failed_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_PROCESSSUPERVISOR_H_
@@ -0,0 +1,182 @@
+/*
+ * RealTimeLog.hpp
+ *
+ *  Created on: August 26, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_REALTIMELOG_H_
+#define NOMAD_REALTIME_REALTIMELOG_H_
+
+// C Includes
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// C++ Includes
+#include <string>
+#include <type_traits>
+
+namespace Realtime
+{
+// Real time safe logging.  Print() copies the format pointer and binary arguments into a preallocated per thread
+// single producer/single consumer ring.  A low priority drain thread formats and writes the records to std::cout, so
+// a control loop never blocks on the stream lock or terminal I/O.  A full ring drops the record and counts it.  A ring is
+// freed by the drain thread once its thread has exited and its last records are written.
+//
+// Format strings use {} placeholders and must be string literals (only the pointer is stored).  String arguments are
+// copied, up to TEXT_SIZE bytes per record.
+//
+//     RealTimeLog::Print("[ConvexMPC]: Solver Time: {} microseconds", duration.count());
+class RealTimeLog
+{
+
+public:
+    // Records per thread ring.  Power of two
+    static const size_t DEFAULT_CAPACITY = 1024;
+
+    // Arguments per record
+    static const int MAX_ARGS = 8;
+
+    // String argument storage per record
+    static const int TEXT_SIZE = 128;
+
+    enum ArgType
+    {
+        INT = 0,
+        UINT,
+        DOUBLE,
+        STRING
+    };
+
+    struct Arg
+    {
+        ArgType type;
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+            struct
+            {
+                uint16_t offset;
+                uint16_t length;
+            } s;
+        };
+    };
+
+    struct Record
+    {
+        uint64_t timestamp_ns;
+        const char *format;
+        int num_args;
+        int text_used;
+        Arg args[MAX_ARGS];
+        char text[TEXT_SIZE];
+    };
+
+    // Log a record from the calling thread.  Never blocks.  Unregistered threads allocate their ring on first use
+    template <typename... Args>
+    static void Print(const char *format, const Args &... args)
+    {
+        Record *record = Reserve();
+        if (record == NULL)
+            return;
+
+        record->format = format;
+        record->num_args = 0;
+        record->text_used = 0;
+        Encode(*record, args...);
+        Commit();
+    }
+
+    // Allocate the calling thread's ring.  Call before the hot loop.  capacity is rounded up to a power of two
+    static void RegisterThread(const size_t capacity = DEFAULT_CAPACITY);
+
+    // Start the drain thread.  Called by the first registration if not started explicitly
+    static void Start();
+
+    // Drain remaining records and stop the drain thread
+    static void Stop();
+
+    // Format and write all pending records from the calling thread
+    static void Flush();
+
+    // Records dropped on full rings
+    static uint64_t GetDropped();
+
+private:
+    // Next free slot in the calling thread's ring.  NULL if full
+    static Record *Reserve();
+
+    // Publish the reserved slot to the drain thread
+    static void Commit();
+
+    static inline void Encode(Record &record) {}
+
+    template <typename T, typename... Rest>
+    static inline void Encode(Record &record, const T &value, const Rest &... rest)
+    {
+        if (record.num_args < MAX_ARGS)
+        {
+            Add(record.args[record.num_args++], record, value);
+        }
+        Encode(record, rest...);
+    }
+
+    template <typename T>
+    static inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type Add(Arg &arg, Record &record, const T value)
+    {
+        arg.type = ArgType::INT;
+        arg.i = value;
+    }
+
+    template <typename T>
+    static inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type Add(Arg &arg, Record &record, const T value)
+    {
+        arg.type = ArgType::UINT;
+        arg.u = value;
+    }
+
+    template <typename T>
+    static inline typename std::enable_if<std::is_floating_point<T>::value>::type Add(Arg &arg, Record &record, const T value)
+    {
+        arg.type = ArgType::DOUBLE;
+        arg.d = value;
+    }
+
+    static inline void Add(Arg &arg, Record &record, const char *value)
+    {
+        const size_t length = value == NULL ? 0 : strnlen(value, TEXT_SIZE - record.text_used);
+        if (length > 0)
+            memcpy(record.text + record.text_used, value, length);
+
+        arg.type = ArgType::STRING;
+        arg.s.offset = record.text_used;
+        arg.s.length = length;
+        record.text_used += length;
+    }
+
+    static inline void Add(Arg &arg, Record &record, const std::string &value)
+    {
+        Add(arg, record, value.c_str());
+    }
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_REALTIMELOG_H_
@@ -34,15 +34,29 @@
 #include <string>
 #include <memory>
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <set>
+#include <functional>
 
 // Third Party Includes
 #include <zcm/zcm-cpp.hpp>
 
 // Project Includes
 #include <Communications/Port.hpp>
+#include <Realtime/TaskStatistics.hpp>
+#include <Realtime/AllocationTracker.hpp>
+#include <Realtime/CpuTopology.hpp>
+#include <Realtime/CpuPower.hpp>
+#include <Realtime/Schedulability.hpp>
+#include <Realtime/ParameterStore.hpp>
+#include <Realtime/PerfCounters.hpp>
+#include <Realtime/TaskArena.hpp>
 
 namespace Realtime
 {
+// Task priorities.  Lower value is a higher priority.  Mapped onto SCHED_FIFO/SCHED_RR priorities as (100 - Priority)
 enum Priority
 {
     LOWEST = 99,
@@ -52,17 +66,58 @@ enum Priority
     HIGHEST = 1
 };
 
+enum SchedulingMode
+{
+    BUSY_WAIT = 0,  // Relative period.  Busy wait the remainder of the period after Run() (TaskDelay)
+    ABSOLUTE_HYBRID, // Absolute deadline.  Sleep until just before the release, then spin the remaining tail
+    DATA_TRIGGERED   // Release on message arrival at a trigger input port (SetTriggerPort)
+};
+
+enum OverrunPolicy
+{
+    SKIP_NEXT = 0, // Drop the missed releases and resync to the next period boundary
+    CATCH_UP,      // Run the missed releases back to back, up to a bounded burst, then resync
+    NOTIFY         // Call OnOverrun() (i.e. publish a cheap fallback), then resync
+};
+
+enum SchedulingPolicy
+{
+    TIME_SHARING = 0, // SCHED_OTHER (CFS)
+    FIFO,             // SCHED_FIFO at the task priority
+    ROUND_ROBIN,      // SCHED_RR at the task priority
+    DEADLINE          // SCHED_DEADLINE.  Runtime from the measured WCET, deadline and period from the task period
+};
+
+enum AdmissionPolicy
+{
+    ADMIT_ALL = 0,   // No schedulability check at task start
+    ADMIT_WARN,      // Check at task start and warn if the task set is infeasible
+    ADMIT_FEASIBLE   // Check at task start and refuse to start a task that makes the task set infeasible
+};
+
 class RealTimeTaskNode
 {
     friend class RealTimeTaskManager;
+    friend class CyclicExecutive;
+    friend class LockstepRunner;
+    friend class WorkerPool;
 
 public:
     static const int MAX_PORTS = 16;
+
+    // Core ID for automatic placement by the RealTimeTaskManager
+    static const int AUTO_AFFINITY = -2;
+
+    // Release offset computed by the RealTimeTaskManager
+    static const long AUTO_OFFSET = -1;
+
+    // Cycles measured under SCHED_OTHER before switching to SCHED_DEADLINE with a measured runtime
+    static const int DEADLINE_CALIBRATION_CYCLES = 100;
     // Base Class Real Time Task Node
     // name = Task Name
     // rt_period = Task Execution Period (microseconds), default = 10000uS/100hz
     // rt_priority = Task Thread Priority -> Priority::MEDIUM,
-    // rt_core_id = CPU Core to pin the task.  -1 for no affinity
+    // rt_core_id = CPU Core to pin the task.  -1 for no affinity, AUTO_AFFINITY for manager placement
     // stack_size = Task Thread Stack Size -> PTHREAD_STACK_MIN
     RealTimeTaskNode(const std::string &name,
                      const long rt_period,
@@ -98,8 +153,118 @@ public:
     // Set Task Period (Microseconds)
     void SetTaskPeriod(const long period) { rt_period_ = period; }
 
-    // Set CPU Core Affinity
-    void SetCoreAffinity(const int core_id) { rt_core_id_ = core_id; }
+    // Set CPU Core Affinity.  -1 for no affinity, AUTO_AFFINITY for manager placement
+    void SetCoreAffinity(const int core_id)
+    {
+        rt_core_id_ = core_id;
+        use_core_mask_ = false;
+    }
+
+    // Set CPU Core Affinity to a set of cores
+    void SetCoreAffinityMask(const cpu_set_t &core_mask)
+    {
+        rt_core_mask_ = core_mask;
+        use_core_mask_ = true;
+    }
+
+    // Set Scheduling Mode -> SchedulingMode::BUSY_WAIT
+    void SetSchedulingMode(const SchedulingMode mode) { scheduling_mode_ = mode; }
+
+    // Set Scheduling Policy -> SchedulingPolicy::TIME_SHARING.  Falls back to TIME_SHARING without CAP_SYS_NICE
+    void SetSchedulingPolicy(const SchedulingPolicy policy) { scheduling_policy_ = policy; }
+
+    // Set SCHED_DEADLINE Runtime (Microseconds).  0 = measure the WCET over a calibration window before switching
+    void SetDeadlineRuntime(const long runtime) { deadline_runtime_ = runtime; }
+
+    // Release the task on message arrival at an input port instead of a timer.  Sets SchedulingMode::DATA_TRIGGERED
+    // min_interarrival = Minimum time between releases (microseconds).  0 for none
+    // timeout = Release anyway if nothing arrives within this time (microseconds).  0 = task period
+    bool SetTriggerPort(const int port_id, const long min_interarrival = 0, const long timeout = 0);
+
+    // Set Overrun Policy -> OverrunPolicy::SKIP_NEXT.  max_catch_up = Burst limit for CATCH_UP
+    // Absolute releases (ABSOLUTE_HYBRID/SCHED_DEADLINE) resync to the release grid.  Relative releases (BUSY_WAIT) resync
+    // by waiting out the rest of the period the overrun ran into, or run at once while catching up
+    void SetOverrunPolicy(const OverrunPolicy policy, const int max_catch_up = 1);
+
+    // Flag the task after this many consecutive missed deadlines.  0 to disable
+    void SetOverrunWatchdog(const int limit) { watchdog_limit_ = limit; }
+
+    // Watchdog has flagged the task.  Latched until ResetWatchdog()
+    bool IsWatchdogTripped() const { return watchdog_tripped_; }
+
+    // Clear the watchdog flag
+    void ResetWatchdog() { watchdog_tripped_ = false; }
+
+    // Set the Worst Case Execution Time used by the schedulability analysis (Microseconds).  0 = calibrated or measured
+    void SetWorstCaseExecutionTime(const long wcet) { wcet_ = wcet; }
+
+    // Set the release offset from the manager's release epoch (Microseconds).  AUTO_OFFSET = computed from the port
+    // graph when the manager's release phasing is on
+    void SetReleaseOffset(const long offset) { release_offset_ = offset; }
+
+    // Set Spin Tail (Microseconds).  Time spent spinning before an absolute release in ABSOLUTE_HYBRID mode
+    void SetSpinTail(const long spin_tail) { spin_tail_ = spin_tail; }
+
+    // Get a snapshot of the task timing statistics
+    void GetStatistics(TaskStatistics::Snapshot &snapshot) const { statistics_.GetSnapshot(snapshot); }
+
+    // Clear the task timing statistics
+    void ResetStatistics() { statistics_.Reset(); }
+
+    // Sample thread CPU time, context switches and page faults around each Run() -> false.  Costs ~4 system calls a cycle
+    void SetResourceAccounting(const bool enable) { resource_accounting_ = enable; }
+
+    // Count heap allocations made inside Run().  flags = AllocationTracker::Flags (BACKTRACE, STRICT)
+    // Requires the REALTIME_ALLOCATION_TRACKER build option
+    void SetAllocationTracking(const bool enable, const int flags = AllocationTracker::NONE);
+
+    // Heap allocations made inside Run() and the number of cycles that allocated
+    void GetAllocationCounters(AllocationTracker::Counters &counters, uint64_t &allocating_cycles) const;
+
+    // Serve heap allocations made inside Run() from a per task arena of capacity bytes, rewound each cycle.  Dynamic size
+    // Eigen matrices and containers local to Run() then cost no system allocations.  Requests that do not fit fall back
+    // to the heap and are counted.  Requires the REALTIME_ALLOCATION_TRACKER build option.  Set before Start()
+    void SetRunArena(const size_t capacity);
+
+    // Arena counters.  False if the task has no arena
+    bool GetArenaCounters(TaskArena::Counters &counters) const;
+
+    // Page faults taken by the task thread since Setup() completed.  False if the task is not running
+    bool GetPageFaults(uint64_t &minor_faults, uint64_t &major_faults) const;
+
+    // Profile stack and heap use to size stack_size and the locked heap reserve.  The stack is filled with a pattern
+    // at startup and scanned for the high water mark, live heap is counted per thread (needs the
+    // REALTIME_ALLOCATION_TRACKER build option).  Reported when the task stops.  Set before Start()
+    void SetMemoryProfiling(const bool enable) { memory_profiling_ = enable; }
+
+    // Stack high water mark and usable stack size (bytes).  False if not profiled
+    bool GetStackUsage(size_t &used, size_t &size) const;
+
+    // Live and peak heap of the task thread (bytes).  False if not profiled
+    bool GetHeapUsage(int64_t &current, int64_t &peak) const;
+
+    // Read hardware performance counters (cycles, instructions, cache and branch misses) and software counters (context
+    // switches, migrations) around each Run().  Falls back to the software counters without a PMU.  Set before Start()
+    void SetPerformanceCounters(const bool enable) { perf_counting_ = enable; }
+
+    // Aggregated performance counters.  False if counting is off or no counter could be opened
+    bool GetPerformanceCounters(PerfCounters::Snapshot &snapshot) const;
+
+    // Call hook on the task thread before the next Run() after the parameter changes.  Rebuild state derived from
+    // parameters (weight matrices, buffers) here instead of in Run().  Register before Start()
+    template <typename T>
+    void OnParameterChange(const Parameter<T> &parameter, const std::function<void()> &hook)
+    {
+        if (!parameter.IsValid())
+            return;
+
+        ParameterStore::ReadGuard params;
+        ParameterHook entry;
+        entry.index = parameter.GetIndex();
+        entry.seen_version = params.GetChangeVersion(entry.index);
+        entry.hook = hook;
+        parameter_hooks_.push_back(entry);
+    }
 
     // Get Output Port
     std::shared_ptr<Port> GetOutputPort(const int port_id) const;
@@ -110,6 +275,16 @@ public:
     // Set Transport Configuration for Port
     void SetPortOutput(const int port_id, const Port::TransportType transport, const std::string &transport_url, const std::string &channel);
 
+    // STATIC Task Delay (More accurate but uses a busy wait)
+    static long int TaskDelay(long int microseconds); // Usuful for tight timings or periods below 1000us
+
+    // Static Task Sleep (Less accurate but less resource intensive) // Useful for sotter timings and periods > 1000us
+    static long int TaskSleep(long int microseconds);
+
+    // STATIC Task Delay Until (Absolute CLOCK_MONOTONIC deadline).  Sleeps until spin_tail microseconds before the
+    // deadline and busy waits the rest.  Returns the release lateness in nanoseconds
+    static long int TaskDelayUntil(const struct timespec &deadline, long int spin_tail);
+
 protected:
 
     // Override Me for thread function
@@ -118,6 +293,9 @@ protected:
     // Setup function called prior to run loop.  Put any setup/initialization here, i.e. socket setup, pub sub etc.
     virtual void Setup() = 0;
 
+    // Called from the task thread when Run() misses its deadline with OverrunPolicy::NOTIFY.  Keep it short
+    virtual void OnOverrun() {}
+
     // Input Port Map
     std::shared_ptr<Port> input_port_map_[MAX_PORTS];
 
@@ -139,12 +317,56 @@ protected:
     // Task CPU Affinboolity/CoreID
     int rt_core_id_;
 
+    // Task CPU Affinity Mask.  Used instead of the core ID when set
+    cpu_set_t rt_core_mask_;
+    bool use_core_mask_;
+
+    // Task Scheduling Mode
+    SchedulingMode scheduling_mode_;
+
+    // Spin Tail before an absolute release (microseconds)
+    long spin_tail_;
+
+    // Requested Scheduling Policy
+    SchedulingPolicy scheduling_policy_;
+
+    // Scheduling Policy actually in effect.  Written by the task thread, read by the manager
+    std::atomic<SchedulingPolicy> active_policy_;
+
+    // SCHED_DEADLINE Runtime (microseconds).  0 = measured
+    long deadline_runtime_;
+
+    // Configured Worst Case Execution Time (microseconds).  0 = calibrated or measured
+    long wcet_;
+
+    // Configured Release Offset (microseconds).  AUTO_OFFSET = computed
+    long release_offset_;
+
+    // Release offset in effect (nanoseconds).  Releases fall on release epoch + offset + k * period when phased
+    uint64_t phase_offset_;
+    bool phased_;
+
+    // Data Trigger Input Port ID and its eventfd
+    int trigger_port_id_;
+    int trigger_fd_;
+
+    // Data Trigger Minimum Inter-arrival and Timeout (microseconds)
+    long trigger_min_interarrival_;
+    long trigger_timeout_;
+
     // Thread ID
     pthread_t thread_id_;
 
     // Process ID
     pid_t process_id_;
 
+    // Kernel Thread ID.  Written by the task thread, read by the manager
+    std::atomic<pid_t> thread_tid_;
+
+    // Page fault counts at the end of Setup()
+    uint64_t minor_faults_base_;
+    uint64_t major_faults_base_;
+
     // Thread Status
     int thread_status_;
 
@@ -154,13 +376,107 @@ protected:
     // Cancellation Signal
     std::atomic_bool thread_cancel_event_;
 
+    // Task thread created
+    bool started_;
+
+    // Hosting Cyclic Executive.  NULL when the task runs on its own thread
+    RealTimeTaskNode *executive_;
+
+    // Overrun Handling
+    OverrunPolicy overrun_policy_;
+    int max_catch_up_;
+    int catch_up_count_;
+    int consecutive_overruns_;
+
+    // Overrun Watchdog
+    int watchdog_limit_;
+    std::atomic_bool watchdog_tripped_;
+
+    // Execution/Lateness Timing Statistics
+    TaskStatistics statistics_;
+
+    // Memory Profiling
+    bool memory_profiling_;
+    uintptr_t stack_low_;
+    uintptr_t stack_high_;
+    size_t stack_high_water_; // Final high water once the thread has exited
+    bool stack_alive_;        // Stack mapped and scannable.  Guarded by profile_mutex_
+    mutable std::mutex profile_mutex_;
+    AllocationTracker::HeapUsage heap_usage_;
+
+    // Per cycle resource usage in the statistics
+    std::atomic_bool resource_accounting_;
+
+    // Performance Counters.  Opened on the thread that runs Run()
+    std::atomic_bool perf_counting_;
+    PerfCounters perf_counters_;
+
+    // Parameter change hooks.  Run on the task thread between cycles
+    struct ParameterHook
+    {
+        int index;
+        uint64_t seen_version;
+        std::function<void()> hook;
+    };
+    std::vector<ParameterHook> parameter_hooks_;
+    uint64_t parameter_version_;
+
+    // Run() Arena
+    std::unique_ptr<TaskArena> run_arena_;
+
+    // Allocation Tracking
+    std::atomic_bool allocation_tracking_;
+    int allocation_flags_;
+    std::atomic<uint64_t> allocations_;
+    std::atomic<uint64_t> frees_;
+    std::atomic<uint64_t> allocated_bytes_;
+    std::atomic<uint64_t> allocating_cycles_;
+
 private:
 
-    // STATIC Task Delay (More accurate but uses a busy wait)
-    static long int TaskDelay(long int microseconds); // Usuful for tight timings or periods below 1000us
+    // Apply the requested scheduling policy to the calling task thread.  Returns 0 on success
+    int ApplySchedulingPolicy();
 
-    // Static Task Sleep (Less accurate but less resource intensive) // Useful for sotter timings and periods > 1000us
-    static long int TaskSleep(long int microseconds);
+    // First release on the epoch grid at or after now.  Now if the task is not phased
+    void AlignRelease(struct timespec &release) const;
+
+    // Missed deadline.  Applies the overrun policy.  Moves next_release for absolute releases, sets delay (microseconds
+    // until the next release) for relative ones
+    void HandleOverrun(struct timespec &next_release, const struct timespec &now, const bool absolute, long int &delay);
+
+    // Block until the trigger port receives a message or the timeout expires.  Honors the minimum inter-arrival from
+    // last_release.  Returns the latency from message arrival to release in nanoseconds (0 on timeout)
+    long int WaitForTrigger(const struct timespec &last_release);
+
+    // Touch the task stack so it is resident before the run loop.  Bounds come from pthread_getattr_np()
+    void PrefaultStack();
+
+    // Fill the unused task stack with STACK_PATTERN and remember its bounds
+    void PaintStack();
+
+    // Print the memory profile
+    void PrintMemoryProfile() const;
+
+    // Run the hooks of parameters changed since the last cycle.  One atomic load when nothing changed
+    void ApplyParameterChanges();
+
+    // Open the performance counters on the calling thread
+    void OpenPerformanceCounters();
+
+    // Print the performance counters
+    void PrintPerformanceCounters() const;
+
+    // Stack fill pattern
+    static const uint64_t STACK_PATTERN = 0xA5A5A5A5A5A5A5A5ULL;
+
+    // Stack left untouched below the prefaulting or painting frame for its callees (bytes)
+    static const size_t STACK_PAINT_MARGIN = 4096;
+
+    // Read the current fault counts of the task thread from /proc
+    bool ReadPageFaults(uint64_t &minor_faults, uint64_t &major_faults) const;
+
+    // Map a task Priority onto a SCHED_FIFO/SCHED_RR priority
+    static int ToSchedPriority(const unsigned int priority);
 
     // STATIC Member Task Run
     static void *RunTask(void *task_instance);
@@ -181,6 +497,35 @@ public:
     // Number of CPU Cores available in the system
     int GetCPUCount() { return cpu_count_; }
 
+    // Real time memory mode.  Locks all current and future memory, disables heap trimming and mmap allocation,
+    // pins malloc to a single arena and pre-touches heap_reserve bytes of it.  Task stacks are prefaulted at task
+    // startup.  Call once from main() before starting any tasks.
+    bool EnableRealtimeMemory(const size_t heap_reserve = 64 * 1024 * 1024);
+
+    // Real time memory mode active
+    bool IsRealtimeMemoryEnabled() const { return rt_memory_enabled_; }
+
+    // True if the process may use real time scheduling policies (CAP_SYS_NICE or an RLIMIT_RTPRIO allowance)
+    bool HasRealtimeCapability() const { return rt_capable_; }
+
+    // Low latency power mode.  Holds a /dev/cpu_dma_latency request at latency_us so idle CPUs stay in states they
+    // can leave within the target, and drops the timer slack of tasks started afterwards.  Sleeping releases then wake
+    // about as fast as spinning ones.  Reports the power state of the real time cores.  Needs root
+    bool EnableLowLatencyMode(const int latency_us = 0);
+
+    // Release the latency request and restore idle states disabled by RestrictIdleStates()
+    void DisableLowLatencyMode();
+
+    // Low latency power mode active
+    bool IsLowLatencyModeEnabled() const { return dma_latency_fd_ >= 0; }
+
+    // Disable the idle states of one CPU with an exit latency above max_latency_us.  A per core alternative to the
+    // system wide request.  Restored by DisableLowLatencyMode() and at exit
+    bool RestrictIdleStates(const int cpu, const int max_latency_us);
+
+    // Report the cpufreq governor and idle states of the cores real time tasks may run on
+    void CheckPowerState();
+
     // Add Task to the Manager
     bool AddTask(RealTimeTaskNode *task);
 
@@ -193,6 +538,53 @@ public:
     // Print the currently active task lists
     void PrintActiveTasks();
 
+    // Automatic core placement for a task (AUTO_AFFINITY).  Tasks at or above the isolation priority get a whole
+    // physical core (SMT siblings left idle) from the isolated cores, or from the non-boot cores without isolcpus.
+    // Everything else shares the remaining housekeeping cores.  Tasks already running on the housekeeping cores are
+    // moved off a core as soon as it is reserved, so the start order does not matter.
+    bool PlaceTask(RealTimeTaskNode *task);
+
+    // Priority at or above which tasks are placed on an exclusive core -> Priority::HIGH
+    void SetIsolationPriority(const unsigned int priority) { isolation_priority_ = priority; }
+
+    // System CPU Topology
+    const CpuTopology &GetTopology() const { return topology_; }
+
+    // Schedulability check applied when a task starts -> AdmissionPolicy::ADMIT_WARN
+    void SetAdmissionPolicy(const AdmissionPolicy policy) { admission_policy_ = policy; }
+
+    // Run the schedulability analysis over every task owned by the manager (hosted tasks are covered by their
+    // executive).  WCETs come from SetWorstCaseExecutionTime(), the SCHED_DEADLINE runtime, a loaded calibration or the
+    // measured statistics, in that order.  True if every task with a known WCET is feasible
+    bool AnalyzeSchedulability(const bool print = true);
+
+    // Admission check for a task about to start, against the tasks already running.  False if the policy refuses it
+    bool AdmitTask(RealTimeTaskNode *task);
+
+    // Phase task releases against a common release epoch.  Offsets follow the port graph: a consumer is released
+    // when its producers have finished (producer offset plus WCET), and independent tasks sharing a CPU are staggered
+    // so their release windows do not overlap.  Each task is placed as it starts against the fixed offsets of the tasks
+    // already running, which never move -> false
+    void SetReleasePhasing(const bool enable) { release_phasing_ = enable; }
+
+    // Restart the release epoch at the shared time base epoch (Systems::TscClock).  Call before starting tasks
+    void ResetReleaseEpoch();
+
+    // Release epoch (CLOCK_MONOTONIC nanoseconds).  Set on first use
+    uint64_t GetReleaseEpoch();
+
+    // Print the release offsets of the phased tasks
+    void PrintReleaseOffsets() const;
+
+    // Set the release offset of a task about to start
+    void PhaseTask(RealTimeTaskNode *task);
+
+    // Write the measured WCET (maximum Run() time) of every task that has run.  One "name wcet_ns" line per task
+    bool SaveWcetCalibration(const std::string &path) const;
+
+    // Read WCETs written by SaveWcetCalibration() from a calibration run
+    bool LoadWcetCalibration(const std::string &path);
+
 private:
 
     // Singleton Instance
@@ -203,6 +595,68 @@ private:
 
     // Max numbers of CPUs
     int cpu_count_;
+
+    // Real time scheduling allowed
+    bool rt_capable_;
+
+    // Real time memory mode active
+    bool rt_memory_enabled_;
+
+    // Low latency power mode.  PM QoS request fd and target
+    int dma_latency_fd_;
+    int dma_latency_target_;
+
+    // Idle states disabled by RestrictIdleStates().  CPU, state index
+    std::vector<std::pair<int, int>> restricted_idle_states_;
+
+    // Find an unreserved physical core for an exclusive placement.  -1 if none
+    int FindFreePhysicalCore() const;
+
+    // Housekeeping CPUs.  Not isolated and not on a core reserved for an exclusive task
+    void GetHousekeepingSet(cpu_set_t &cpu_set) const;
+
+    // Re-apply the housekeeping CPUs to the tasks already placed on them after the reservations changed
+    void UpdateHousekeepingTasks();
+
+    // Analysis model of a task.  Period, WCET, policy and core
+    SchedulabilityAnalyzer::TaskModel BuildTaskModel(const RealTimeTaskNode *task) const;
+
+    // Schedulability check at task start
+    AdmissionPolicy admission_policy_;
+
+    // Release slot of a phased task.  Frozen when the task starts so later starts place around the same windows
+    struct ReleaseSlot
+    {
+        uint64_t offset_ns; // Offset from the release epoch
+        uint64_t wcet_ns;   // WCET at start
+        cpu_set_t cpus;     // CPUs the task may run on
+    };
+
+    // True if one of producer's outputs is mapped to one of consumer's inputs
+    bool Feeds(const RealTimeTaskNode *producer, const RealTimeTaskNode *consumer) const;
+
+    // Place a starting task against the release slots of the running tasks
+    void PlaceRelease(RealTimeTaskNode *task);
+
+    // Release phasing
+    bool release_phasing_;
+    uint64_t release_epoch_ns_;
+    std::map<RealTimeTaskNode *, ReleaseSlot> release_slots_;
+
+    // WCETs from a calibration run (nanoseconds), by task name
+    std::map<std::string, uint64_t> calibrated_wcet_;
+
+    // CPU Topology
+    CpuTopology topology_;
+
+    // Priority for exclusive core placement
+    unsigned int isolation_priority_;
+
+    // Physical cores reserved for exclusive tasks
+    std::map<RealTimeTaskNode *, int> reserved_cores_;
+
+    // Tasks placed on the housekeeping cores
+    std::set<RealTimeTaskNode *> housekeeping_tasks_;
 };
 } // namespace Realtime
 
@@ -0,0 +1,115 @@
+/*
+ * Schedulability.hpp
+ *
+ *  Created on: August 31, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef NOMAD_REALTIME_SCHEDULABILITY_H_
+#define NOMAD_REALTIME_SCHEDULABILITY_H_
+
+// C Includes
+#include <stdint.h>
+
+// C++ Includes
+#include <string>
+#include <vector>
+
+namespace Realtime
+{
+// Offline schedulability tests for a task set.  Fixed priority (SCHED_FIFO/SCHED_RR) tasks pinned to one core get an
+// exact response time analysis against the higher and equal priority tasks that can run on that core, with
+// SCHED_DEADLINE tasks counted as top priority.  SCHED_DEADLINE tasks get the global EDF (GFB) utilization test against
+// the kernel's deadline bandwidth.  Implicit deadlines (deadline = period).
+class SchedulabilityAnalyzer
+{
+
+public:
+    enum SchedulingClass
+    {
+        FIXED_PRIORITY = 0, // SCHED_FIFO/SCHED_RR
+        EARLIEST_DEADLINE,  // SCHED_DEADLINE
+        BEST_EFFORT         // SCHED_OTHER.  No guarantee, only checked against its own period
+    };
+
+    struct TaskModel
+    {
+        std::string name;
+        SchedulingClass scheduling_class;
+        int sched_priority;      // SCHED_FIFO/SCHED_RR priority.  Higher runs first
+        int core;                // Pinned logical CPU.  -1 if the task may run on several
+        uint64_t period_ns;      // Period (and deadline)
+        uint64_t wcet_ns;        // Worst case execution time.  0 = unknown, task is not analyzed
+        std::string wcet_source; // Where the WCET came from, for the report
+    };
+
+    struct Result
+    {
+        std::string name;
+        bool analyzed;        // False without a WCET
+        bool feasible;        // Meets its deadline under the test applied
+        uint64_t response_ns; // Worst case response time (fixed priority on one core).  0 otherwise
+        double utilization;   // WCET / period
+        std::string test;     // Test applied
+    };
+
+    SchedulabilityAnalyzer();
+
+    // Add a task to the set
+    void AddTask(const TaskModel &task) { tasks_.push_back(task); }
+
+    // Remove all tasks and results
+    void Clear();
+
+    // CPUs in the SCHED_DEADLINE root domain
+    void SetCPUCount(const int cpu_count) { cpu_count_ = cpu_count; }
+
+    // Fraction of each CPU available to SCHED_DEADLINE tasks -> sched_rt_runtime_us / sched_rt_period_us
+    void SetDeadlineBandwidth(const double bandwidth) { deadline_bandwidth_ = bandwidth; }
+
+    // Run the tests.  True if every analyzed task is feasible
+    bool Analyze();
+
+    // Per task results of the last Analyze()
+    const std::vector<Result> &GetResults() const { return results_; }
+
+    // Print the results of the last Analyze()
+    void Print() const;
+
+    // Kernel real time bandwidth from /proc/sys/kernel.  1.0 if unlimited or unreadable
+    static double ReadDeadlineBandwidth();
+
+    // Fixed priority response time of a task against its interfering tasks.  Iterates
+    // R = C + sum(ceil(R / Tj) * Cj) to a fixed point.  Returns 0 once R passes the deadline
+    static uint64_t ResponseTime(const TaskModel &task, const std::vector<const TaskModel *> &interference);
+
+protected:
+
+    // Task Set
+    std::vector<TaskModel> tasks_;
+
+    // Last Results
+    std::vector<Result> results_;
+
+    // SCHED_DEADLINE root domain
+    int cpu_count_;
+    double deadline_bandwidth_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_SCHEDULABILITY_H_
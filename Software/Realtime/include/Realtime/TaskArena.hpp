@@ -0,0 +1,137 @@
+/*
+ * TaskArena.hpp
+ *
+ *  Created on: September 6, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef NOMAD_REALTIME_TASKARENA_H_
+#define NOMAD_REALTIME_TASKARENA_H_
+
+// C Includes
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ Includes
+#include <atomic>
+
+namespace Realtime
+{
+// Per task monotonic arena.  Between Begin() and End() the malloc family of the calling thread (and so operator new
+// and Eigen's aligned allocator) bumps a pointer in a locked, pre-touched region instead of calling into the heap, and
+// free() of an arena block only drops a live count.  The arena rewinds at the next Begin() once every block is freed,
+// so dynamic size matrices built and destroyed inside Run() cost no system allocations.  The arena arms after the first
+// cycle whose allocations are all freed by its end; until then allocations go to the heap, so members Run() sizes on
+// its first cycles are not pinned in the arena.  Blocks that outlive a later cycle hold the rewind off until they are
+// freed; those cycles are counted.  Requests that do not fit fall back to the heap and are counted as overflows.
+// Requires the library built with REALTIME_ALLOCATION_TRACKER, which interposes the malloc family.
+class TaskArena
+{
+
+public:
+    // Plain copy of the arena counters for readers
+    struct Counters
+    {
+        uint64_t capacity;        // Arena size (bytes)
+        uint64_t cycles;          // Begin()/End() pairs
+        uint64_t warmup_cycles;   // Cycles run on the heap before the arena armed
+        bool armed;               // Serving allocations
+        uint64_t allocations;     // Blocks served from the arena
+        uint64_t bytes;           // Bytes requested from the arena
+        uint64_t peak_bytes;      // High water of the arena (bytes, with headers and padding)
+        uint64_t overflows;       // Requests that fell back to the heap
+        uint64_t overflow_bytes;  // Bytes that fell back to the heap
+        uint64_t escaped_cycles;  // Cycles ending with arena blocks still live.  The arena did not rewind after these
+        int64_t live_blocks;      // Arena blocks not yet freed
+    };
+
+    // capacity = Arena Size (bytes).  Mapped and touched here, outside the real time loop
+    explicit TaskArena(const size_t capacity);
+
+    // Unmaps the arena.  If blocks are still live the mapping is handed to the registry and unmapped once a later
+    // arena finds them all freed, so those blocks can still be freed after the arena is gone
+    ~TaskArena();
+
+    // Arena mapped
+    bool IsValid() const { return base_ != NULL; }
+
+    // Arena Size (bytes)
+    size_t GetCapacity() const { return capacity_; }
+
+    // Copy out the counters.  Safe to call from any thread
+    void GetCounters(Counters &counters) const;
+
+    // True if the malloc hooks are compiled in
+    static bool IsAvailable();
+
+    // Serve the calling thread's allocations from arena until End().  Rewinds the arena if no blocks are live.  NULL
+    // serves them from the heap.  Returns the arena active before, to hand back to End().  Calls nest
+    static TaskArena *Begin(TaskArena *arena);
+
+    // Back to previous (the return of the matching Begin()) for the calling thread
+    static void End(TaskArena *previous = NULL);
+
+    // Malloc hooks.  Never allocate
+
+    // Block from the calling thread's active arena.  NULL if none is active or the request overflows
+    static void *Allocate(const size_t size, const size_t alignment);
+
+    // Release an arena block.  False if ptr is not in an arena
+    static bool Release(void *ptr);
+
+    // Requested size of an arena block.  False if ptr is not in an arena
+    static bool BlockSize(const void *ptr, size_t &size);
+
+    // Maximum number of arenas alive at once
+    static const int MAX_ARENAS = 64;
+
+    // Registry record of an arena mapping.  Never freed, so it outlives the arena that owned it
+    struct Region;
+
+protected:
+    // Region holding ptr.  NULL if none
+    static Region *Find(const void *ptr);
+
+    // Arena Memory
+    unsigned char *base_;
+    size_t capacity_;
+
+    // Registry record of base_.  Holds the live block count
+    Region *region_;
+
+    // Bump offset.  Owning thread only
+    size_t offset_;
+
+    // Warm up.  Heap allocations and frees of the current cycle until a cycle frees all it allocated.  Owning thread only
+    std::atomic_bool armed_;
+    uint64_t warmup_allocations_;
+    uint64_t warmup_frees_;
+
+    // Counters.  Written by the owning thread only
+    std::atomic<uint64_t> cycles_;
+    std::atomic<uint64_t> warmup_cycles_;
+    std::atomic<uint64_t> allocations_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> peak_bytes_;
+    std::atomic<uint64_t> overflows_;
+    std::atomic<uint64_t> overflow_bytes_;
+    std::atomic<uint64_t> escaped_cycles_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_TASKARENA_H_
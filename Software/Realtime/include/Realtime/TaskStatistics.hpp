@@ -0,0 +1,165 @@
+/*
+ * TaskStatistics.hpp
+ *
+ *  Created on: August 12, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_TASKSTATISTICS_H_
+#define NOMAD_REALTIME_TASKSTATISTICS_H_
+
+// C Includes
+#include <stdint.h>
+
+// C++ Includes
+#include <atomic>
+
+namespace Realtime
+{
+class TaskStatistics
+{
+
+public:
+    // Log2 histogram buckets.  Bucket i holds samples in [2^i, 2^(i+1)) nanoseconds.  32 buckets covers ~4 seconds
+    static const int NUM_BUCKETS = 32;
+
+    // Plain copy of the statistics for readers
+    struct Snapshot
+    {
+        uint64_t cycles;              // Number of completed cycles
+        uint64_t overruns;            // Number of cycles where Run() exceeded the task period
+        uint64_t execution_total_ns;  // Sum of Run() execution times
+        uint64_t execution_max_ns;    // Worst case Run() execution time
+        uint64_t lateness_total_ns;   // Sum of release lateness
+        uint64_t lateness_max_ns;     // Worst case release lateness
+
+        // Resource usage of Run().  Only for cycles recorded with usage samples
+        uint64_t accounted_cycles;      // Cycles recorded with usage
+        uint64_t cpu_total_ns;          // Sum of Run() thread CPU time
+        uint64_t cpu_max_ns;            // Worst case Run() thread CPU time
+        uint64_t interference_total_ns; // Sum of Run() wall time off the CPU (preempted or blocked)
+        uint64_t interference_max_ns;   // Worst case Run() wall time off the CPU
+        uint64_t voluntary_switches;    // Context switches inside Run() where the task blocked
+        uint64_t involuntary_switches;  // Context switches inside Run() where the task was preempted
+        uint64_t preempted_cycles;      // Cycles with at least one involuntary switch
+        uint64_t minor_faults;          // Page faults inside Run()
+        uint64_t major_faults;          // Page faults inside Run() that went to disk
+        uint64_t faulting_cycles;       // Cycles with at least one page fault
+
+        uint64_t execution_histogram[NUM_BUCKETS];
+        uint64_t lateness_histogram[NUM_BUCKETS];
+        uint64_t cpu_histogram[NUM_BUCKETS];
+
+        // Mean Run() execution time (nanoseconds)
+        double MeanExecutionTime() const { return cycles ? (double)execution_total_ns / cycles : 0.0; }
+
+        // Mean release lateness (nanoseconds)
+        double MeanLateness() const { return cycles ? (double)lateness_total_ns / cycles : 0.0; }
+
+        // Mean Run() thread CPU time (nanoseconds)
+        double MeanCpuTime() const { return accounted_cycles ? (double)cpu_total_ns / accounted_cycles : 0.0; }
+
+        // Mean Run() time off the CPU (nanoseconds)
+        double MeanInterference() const { return accounted_cycles ? (double)interference_total_ns / accounted_cycles : 0.0; }
+
+        // Upper bound (nanoseconds) of the bucket containing the given percentile [0,1] of a histogram
+        static uint64_t Percentile(const uint64_t (&histogram)[NUM_BUCKETS], double percentile);
+    };
+
+    // Resource usage of the calling thread.  CPU time from CLOCK_THREAD_CPUTIME_ID, the rest from getrusage(RUSAGE_THREAD)
+    struct Usage
+    {
+        uint64_t cpu_ns;
+        uint64_t voluntary_switches;
+        uint64_t involuntary_switches;
+        uint64_t minor_faults;
+        uint64_t major_faults;
+    };
+
+    TaskStatistics();
+
+    // Clear all counters.  Not synchronized with an active writer, counts may be briefly inconsistent while running
+    void Reset();
+
+    // Record a completed cycle.  Single writer (the task thread) only.  Lock free
+    void Record(uint64_t execution_ns, uint64_t lateness_ns, bool overrun);
+
+    // Record a completed cycle with the task thread usage sampled before and after Run()
+    void Record(uint64_t execution_ns, uint64_t lateness_ns, bool overrun, const Usage &start, const Usage &end);
+
+    // Sample the calling thread's usage.  Two system calls
+    static void ReadUsage(Usage &usage);
+
+    // Number of recorded cycles
+    uint64_t Cycles() const { return cycles_.load(std::memory_order_acquire); }
+
+    // Copy out the current statistics.  Safe to call from any thread
+    void GetSnapshot(Snapshot &snapshot) const;
+
+    // Histogram bucket for a duration
+    static inline int Bucket(uint64_t ns)
+    {
+        if (ns < 2)
+            return 0;
+
+        int bucket = 63 - __builtin_clzll(ns);
+        return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+    }
+
+protected:
+
+    // Increment a single writer counter without a locked read-modify-write
+    static inline void Increment(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // Raise a single writer maximum
+    static inline void Max(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        if (value > counter.load(std::memory_order_relaxed))
+            counter.store(value, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> cycles_;
+    std::atomic<uint64_t> overruns_;
+    std::atomic<uint64_t> execution_total_ns_;
+    std::atomic<uint64_t> execution_max_ns_;
+    std::atomic<uint64_t> lateness_total_ns_;
+    std::atomic<uint64_t> lateness_max_ns_;
+
+    std::atomic<uint64_t> accounted_cycles_;
+    std::atomic<uint64_t> cpu_total_ns_;
+    std::atomic<uint64_t> cpu_max_ns_;
+    std::atomic<uint64_t> interference_total_ns_;
+    std::atomic<uint64_t> interference_max_ns_;
+    std::atomic<uint64_t> voluntary_switches_;
+    std::atomic<uint64_t> involuntary_switches_;
+    std::atomic<uint64_t> preempted_cycles_;
+    std::atomic<uint64_t> minor_faults_;
+    std::atomic<uint64_t> major_faults_;
+    std::atomic<uint64_t> faulting_cycles_;
+
+    std::atomic<uint64_t> execution_histogram_[NUM_BUCKETS];
+    std::atomic<uint64_t> lateness_histogram_[NUM_BUCKETS];
+    std::atomic<uint64_t> cpu_histogram_[NUM_BUCKETS];
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_TASKSTATISTICS_H_
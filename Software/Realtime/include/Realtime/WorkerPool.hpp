@@ -0,0 +1,153 @@
+/*
+ * WorkerPool.hpp
+ *
+ *  Created on: August 28, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef NOMAD_REALTIME_WORKERPOOL_H_
+#define NOMAD_REALTIME_WORKERPOOL_H_
+
+// C Includes
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+
+// C++ Includes
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Project Includes
+#include <Communications/PortMutex.hpp>
+#include <Realtime/RealTimeTask.hpp>
+
+namespace Realtime
+{
+// Fork-join worker pool for parallelism inside one task cycle.  Workers are created once with their own affinity and
+// real time priority.  ParallelFor() splits an index range into chunks that the calling task thread and the workers
+// claim from a shared counter, so idle threads take the remaining work.  Dispatch does not allocate.  Workers spin for
+// spin_time after each job, so back to back cycles wake without a syscall, then sleep on a futex.  Pin the workers to
+// cores other than the dispatching task; a spinning worker sharing its core only delays the join.
+//
+// One dispatch runs at a time.  Nodes sharing a pool serialize on a priority inheriting mutex, so a low priority node
+// holding the pool is boosted instead of blocking a higher priority one.  Prefer one pool per node.
+class WorkerPool
+{
+
+public:
+    // Worker Pool
+    // name = Pool Name
+    // num_workers = Worker threads.  The dispatching thread also runs chunks, so N workers give N + 1 way parallelism
+    // rt_priority = Worker Priority -> Priority::HIGH
+    // spin_time = Time (microseconds) workers busy wait for the next job before sleeping
+    // stack_size = Worker Thread Stack Size
+    WorkerPool(const std::string &name,
+               const int num_workers,
+               const unsigned int rt_priority = Priority::HIGH,
+               const long spin_time = 50,
+               const unsigned int stack_size = PTHREAD_STACK_MIN);
+
+    ~WorkerPool();
+
+    // Pin a worker to a CPU core.  Call before Start()
+    void SetWorkerAffinity(const int worker, const int core);
+
+    // Scheduling policy for the workers -> SchedulingPolicy::FIFO.  Call before Start()
+    void SetSchedulingPolicy(const SchedulingPolicy policy) { scheduling_policy_ = policy; }
+
+    // Create the workers
+    bool Start();
+
+    // Join the workers
+    void Stop();
+
+    // Worker Count
+    int GetWorkerCount() const { return num_workers_; }
+
+    // Call body(i) for every i in [begin, end) across the pool and the calling thread.  Returns when all are done.
+    // grain = Indices claimed per chunk.  Runs inline if the pool is not started
+    template <typename Body>
+    void ParallelFor(const int begin, const int end, const Body &body, const int grain = 1)
+    {
+        Dispatch(begin, end, grain, &Invoke<Body>, const_cast<void *>(static_cast<const void *>(&body)));
+    }
+
+protected:
+    // Type erased chunk function.  Runs [begin, end)
+    typedef void (*ChunkFunction)(void *context, int begin, int end);
+
+    template <typename Body>
+    static void Invoke(void *context, const int begin, const int end)
+    {
+        const Body &body = *static_cast<const Body *>(context);
+        for (int i = begin; i < end; i++)
+        {
+            body(i);
+        }
+    }
+
+    // Publish a job, run chunks on the calling thread and wait for the workers
+    void Dispatch(const int begin, const int end, const int grain, ChunkFunction function, void *context);
+
+    // Claim and run chunks until the range is exhausted
+    void RunChunks();
+
+    // Worker thread
+    static void *WorkerThread(void *arg);
+
+    // Pool Name
+    std::string name_;
+
+    // Workers
+    int num_workers_;
+    unsigned int rt_priority_;
+    SchedulingPolicy scheduling_policy_;
+    long spin_time_;
+    unsigned int stack_size_;
+    std::vector<int> worker_cores_;
+    std::vector<pthread_t> threads_;
+    bool running_;
+
+    // Current Job
+    ChunkFunction function_;
+    void *context_;
+    int end_;
+    int grain_;
+    alignas(64) std::atomic<int> next_;
+
+    // Job generation.  Workers wait on a change (futex word)
+    alignas(64) std::atomic<int> epoch_;
+
+    // Workers still inside the current job
+    alignas(64) std::atomic<int> active_;
+
+    // Workers blocked on the futex
+    std::atomic<int> sleepers_;
+
+    // Stop request
+    std::atomic_bool stop_;
+
+    // One dispatch at a time.  PTHREAD_PRIO_INHERIT
+    PortMutex dispatch_mutex_;
+};
+} // namespace Realtime
+
+#endif // NOMAD_REALTIME_WORKERPOOL_H_
@@ -0,0 +1,279 @@
+/*
+ * AllocationTracker.cpp
+ *
+ *  Created on: August 14, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Realtime/AllocationTracker.hpp>
+#include <Realtime/TaskArena.hpp>
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <execinfo.h>
+
+namespace
+{
+// Thread state.  Plain __thread POD so the hooks never allocate to reach it
+struct TrackerState
+{
+    bool active;
+    bool in_hook;
+    int flags;
+    int reports;
+    const char *name;
+    Realtime::AllocationTracker::Counters counters;
+};
+
+__thread TrackerState tracker_state;
+
+// Live heap accounting.  NULL when off
+__thread Realtime::AllocationTracker::HeapUsage *heap_usage = NULL;
+
+// Allocation made while tracking.  Only async-signal-safe output here, iostreams would allocate
+void ReportAllocation(size_t size)
+{
+    TrackerState &state = tracker_state;
+    if (state.in_hook)
+        return;
+
+    state.in_hook = true;
+    const bool strict = state.flags & Realtime::AllocationTracker::STRICT;
+    if (((state.flags & Realtime::AllocationTracker::BACKTRACE) && state.reports < Realtime::AllocationTracker::MAX_REPORTS) || strict)
+    {
+        char message[256];
+        int length = snprintf(message, sizeof(message), "[AllocationTracker]: %s allocated %zu bytes inside Run()\n", state.name, size);
+        if (write(STDERR_FILENO, message, length) < 0)
+        {
+        }
+
+        void *frames[32];
+        int num_frames = backtrace(frames, 32);
+        backtrace_symbols_fd(frames, num_frames, STDERR_FILENO);
+        state.reports++;
+    }
+
+    if (strict)
+    {
+        abort();
+    }
+    state.in_hook = false;
+}
+
+inline void OnAllocate(size_t size)
+{
+    TrackerState &state = tracker_state;
+    if (!state.active)
+        return;
+
+    state.counters.allocations++;
+    state.counters.bytes += size;
+    if (state.flags != Realtime::AllocationTracker::NONE)
+        ReportAllocation(size);
+}
+
+inline void OnFree(void *ptr)
+{
+    if (ptr != NULL && tracker_state.active)
+        tracker_state.counters.frees++;
+}
+
+// Live heap change of the calling thread.  Single writer, so no locked read-modify-write
+inline void OnHeapChange(const int64_t delta)
+{
+    Realtime::AllocationTracker::HeapUsage *usage = heap_usage;
+    if (usage == NULL)
+        return;
+
+    const int64_t current = usage->current_bytes.load(std::memory_order_relaxed) + delta;
+    usage->current_bytes.store(current, std::memory_order_relaxed);
+    if (current > usage->peak_bytes.load(std::memory_order_relaxed))
+        usage->peak_bytes.store(current, std::memory_order_relaxed);
+}
+
+inline void *OnAllocated(void *ptr)
+{
+    if (ptr != NULL && heap_usage != NULL)
+        OnHeapChange(malloc_usable_size(ptr));
+    return ptr;
+}
+} // namespace
+
+#ifdef REALTIME_ALLOCATION_TRACKER
+// Interpose the malloc family.  operator new/delete and Eigen's aligned allocator land here through libstdc++/libc.
+// A thread inside a TaskArena is served from the arena first; only overflows reach the heap and the counters
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *ptr);
+
+    void *malloc(size_t size)
+    {
+        void *block = Realtime::TaskArena::Allocate(size, alignof(max_align_t));
+        if (block != NULL)
+            return block;
+
+        OnAllocate(size);
+        return OnAllocated(__libc_malloc(size));
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        if (size != 0 && count > SIZE_MAX / size)
+        {
+            errno = ENOMEM;
+            return NULL;
+        }
+
+        // Arena memory is reused, so clear it
+        void *block = Realtime::TaskArena::Allocate(count * size, alignof(max_align_t));
+        if (block != NULL)
+            return memset(block, 0, count * size);
+
+        OnAllocate(count * size);
+        return OnAllocated(__libc_calloc(count, size));
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        // Arena blocks move to a new block (arena or heap).  The old one is only released
+        size_t old_size;
+        if (ptr != NULL && Realtime::TaskArena::BlockSize(ptr, old_size))
+        {
+            if (size == 0)
+            {
+                Realtime::TaskArena::Release(ptr);
+                return NULL;
+            }
+
+            void *result = malloc(size);
+            if (result == NULL)
+                return NULL;
+
+            memcpy(result, ptr, old_size < size ? old_size : size);
+            Realtime::TaskArena::Release(ptr);
+            return result;
+        }
+
+        if (ptr == NULL)
+            return malloc(size);
+
+        OnAllocate(size);
+        old_size = heap_usage != NULL ? malloc_usable_size(ptr) : 0;
+        void *result = __libc_realloc(ptr, size);
+
+        // A failed realloc leaves the old block in place
+        if (result != NULL || size == 0)
+            OnHeapChange(-(int64_t)old_size);
+        return OnAllocated(result);
+    }
+
+    void *memalign(size_t alignment, size_t size)
+    {
+        void *block = Realtime::TaskArena::Allocate(size, alignment);
+        if (block != NULL)
+            return block;
+
+        OnAllocate(size);
+        return OnAllocated(__libc_memalign(alignment, size));
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size)
+    {
+        return memalign(alignment, size);
+    }
+
+    int posix_memalign(void **ptr, size_t alignment, size_t size)
+    {
+        if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        *ptr = memalign(alignment, size);
+        return (*ptr == NULL && size != 0) ? ENOMEM : 0;
+    }
+
+    void free(void *ptr)
+    {
+        if (ptr != NULL && Realtime::TaskArena::Release(ptr))
+            return;
+
+        OnFree(ptr);
+        if (ptr != NULL && heap_usage != NULL)
+            OnHeapChange(-(int64_t)malloc_usable_size(ptr));
+        __libc_free(ptr);
+    }
+}
+#endif
+
+namespace Realtime
+{
+bool AllocationTracker::IsAvailable()
+{
+#ifdef REALTIME_ALLOCATION_TRACKER
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationTracker::Begin(const char *name, int flags)
+{
+    TrackerState &state = tracker_state;
+    if (flags != Flags::NONE && state.reports == 0 && !state.active)
+    {
+        // First backtrace() call loads libgcc and allocates.  Take it here, outside the tracked region
+        void *frame;
+        backtrace(&frame, 1);
+    }
+
+    state.name = name;
+    state.flags = flags;
+    state.counters.allocations = 0;
+    state.counters.frees = 0;
+    state.counters.bytes = 0;
+    state.active = true;
+}
+
+AllocationTracker::Counters AllocationTracker::End()
+{
+    TrackerState &state = tracker_state;
+    state.active = false;
+    return state.counters;
+}
+
+void AllocationTracker::BeginHeapProfile(HeapUsage *usage)
+{
+    usage->current_bytes = 0;
+    usage->peak_bytes = 0;
+    heap_usage = usage;
+}
+
+void AllocationTracker::EndHeapProfile()
+{
+    heap_usage = NULL;
+}
+} // namespace Realtime
@@ -0,0 +1,95 @@
+/*
+ * CpuPower.cpp
+ *
+ *  Created on: September 3, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <Realtime/CpuPower.hpp>
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <fstream>
+
+namespace Realtime
+{
+static std::string ReadLine(const std::string &path)
+{
+    std::ifstream file(path);
+    std::string contents;
+    std::getline(file, contents);
+    return contents;
+}
+
+std::string CpuPower::GetGovernor(const int cpu, const std::string &sysfs_root)
+{
+    return ReadLine(sysfs_root + "/cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+}
+
+std::vector<CpuPower::IdleState> CpuPower::GetIdleStates(const int cpu, const std::string &sysfs_root)
+{
+    std::vector<IdleState> states;
+    for (int index = 0;; index++)
+    {
+        const std::string state = sysfs_root + "/cpu" + std::to_string(cpu) + "/cpuidle/state" + std::to_string(index) + "/";
+        const std::string name = ReadLine(state + "name");
+        if (name.empty())
+            break;
+
+        const std::string latency = ReadLine(state + "latency");
+        const std::string disabled = ReadLine(state + "disable");
+
+        IdleState info;
+        info.index = index;
+        info.name = name;
+        info.latency_us = latency.empty() ? 0 : std::stol(latency);
+        info.disabled = (disabled == "1");
+        states.push_back(info);
+    }
+    return states;
+}
+
+bool CpuPower::SetIdleStateDisabled(const int cpu, const int index, const bool disabled, const std::string &sysfs_root)
+{
+    std::ofstream file(sysfs_root + "/cpu" + std::to_string(cpu) + "/cpuidle/state" + std::to_string(index) + "/disable");
+    if (!file.is_open())
+        return false;
+
+    file << (disabled ? "1" : "0");
+    file.flush();
+    return file.good();
+}
+
+int CpuPower::OpenLatencyRequest(const int latency_us)
+{
+    int fd = open("/dev/cpu_dma_latency", O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    // Binary s32 in microseconds
+    const int32_t target = latency_us;
+    if (write(fd, &target, sizeof(target)) != sizeof(target))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+} // namespace Realtime
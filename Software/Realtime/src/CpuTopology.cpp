@@ -0,0 +1,176 @@
+/*
+ * CpuTopology.cpp
+ *
+ *  Created on: August 16, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Realtime/CpuTopology.hpp>
+
+#include <unistd.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace Realtime
+{
+CpuTopology::CpuTopology()
+{
+}
+
+bool CpuTopology::Load(const std::string &sysfs_root)
+{
+    cpus_.clear();
+
+    std::vector<int> online = ParseCPUList(ReadFile(sysfs_root + "/online"));
+    if (online.empty())
+    {
+        // No sysfs.  Assume a flat topology
+        for (int i = 0; i < sysconf(_SC_NPROCESSORS_ONLN); i++)
+        {
+            online.push_back(i);
+        }
+    }
+
+    std::vector<int> isolated = ParseCPUList(ReadFile(sysfs_root + "/isolated"));
+    std::vector<int> nohz_full = ParseCPUList(ReadFile(sysfs_root + "/nohz_full"));
+
+    for (int cpu : online)
+    {
+        const std::string topology = sysfs_root + "/cpu" + std::to_string(cpu) + "/topology/";
+
+        CPUInfo info;
+        info.cpu = cpu;
+
+        std::string core_id = ReadFile(topology + "core_id");
+        std::string package_id = ReadFile(topology + "physical_package_id");
+        info.core_id = core_id.empty() ? cpu : std::stoi(core_id);
+        info.package_id = package_id.empty() ? 0 : std::stoi(package_id);
+
+        info.siblings = ParseCPUList(ReadFile(topology + "thread_siblings_list"));
+        if (info.siblings.empty())
+        {
+            info.siblings.push_back(cpu);
+        }
+
+        info.isolated = std::find(isolated.begin(), isolated.end(), cpu) != isolated.end();
+        info.nohz_full = std::find(nohz_full.begin(), nohz_full.end(), cpu) != nohz_full.end();
+
+        cpus_.push_back(info);
+    }
+    return !cpus_.empty();
+}
+
+const CpuTopology::CPUInfo *CpuTopology::GetCPU(const int cpu) const
+{
+    for (const CPUInfo &info : cpus_)
+    {
+        if (info.cpu == cpu)
+            return &info;
+    }
+    return NULL;
+}
+
+int CpuTopology::GetPhysicalCore(const int cpu) const
+{
+    const CPUInfo *info = GetCPU(cpu);
+    if (info == NULL)
+        return -1;
+
+    return *std::min_element(info->siblings.begin(), info->siblings.end());
+}
+
+void CpuTopology::GetHousekeepingSet(cpu_set_t &cpu_set) const
+{
+    CPU_ZERO(&cpu_set);
+    for (const CPUInfo &info : cpus_)
+    {
+        if (!info.isolated)
+            CPU_SET(info.cpu, &cpu_set);
+    }
+}
+
+bool CpuTopology::HasIsolatedCPUs() const
+{
+    for (const CPUInfo &info : cpus_)
+    {
+        if (info.isolated)
+            return true;
+    }
+    return false;
+}
+
+void CpuTopology::Print() const
+{
+    for (const CPUInfo &info : cpus_)
+    {
+        std::cout << "[CpuTopology]: CPU: " << info.cpu << "\tPackage: " << info.package_id << "\tCore: " << info.core_id
+                  << "\tSiblings: [";
+        for (int sibling : info.siblings)
+        {
+            std::cout << " " << sibling;
+        }
+        std::cout << " ]" << (info.isolated ? "\tISOLATED" : "") << (info.nohz_full ? "\tNOHZ_FULL" : "") << std::endl;
+    }
+}
+
+std::string CpuTopology::FormatCPUSet(const cpu_set_t &cpu_set)
+{
+    std::string list;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, &cpu_set))
+        {
+            list += (list.empty() ? "" : " ") + std::to_string(cpu);
+        }
+    }
+    return list;
+}
+
+std::vector<int> CpuTopology::ParseCPUList(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty() || !isdigit(range[0]))
+            continue;
+
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::string CpuTopology::ReadFile(const std::string &path)
+{
+    std::ifstream file(path);
+    std::string contents;
+    std::getline(file, contents);
+    return contents;
+}
+} // namespace Realtime
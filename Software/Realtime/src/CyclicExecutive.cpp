@@ -0,0 +1,300 @@
+/*
+ * CyclicExecutive.cpp
+ *
+ *  Created on: August 19, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Realtime/CyclicExecutive.hpp>
+
+#include <time.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <iostream>
+#include <numeric>
+
+namespace Realtime
+{
+static inline uint64_t MonotonicNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+CyclicExecutive::CyclicExecutive(const std::string &name,
+                                 const unsigned int rt_priority,
+                                 const int rt_core_id,
+                                 const unsigned int stack_size) : RealTimeTaskNode(name, 10000, rt_priority, rt_core_id, stack_size),
+                                                                  minor_frame_(0),
+                                                                  major_frame_(0),
+                                                                  frame_index_(0)
+{
+    // Frames are absolute releases.  A relative busy wait would drift across the major frame
+    SetSchedulingMode(SchedulingMode::ABSOLUTE_HYBRID);
+}
+
+bool CyclicExecutive::AddTask(RealTimeTaskNode *task)
+{
+    assert(task != NULL && task != this);
+
+    // The schedule is fixed once the executive thread runs.  Frames would change under Run()
+    if (started_)
+    {
+        std::cout << "[CyclicExecutive]: Cannot host task " << task->task_name_ << " after Start()" << std::endl;
+        return false;
+    }
+
+    for (const Entry &entry : tasks_)
+    {
+        if (entry.task == task)
+        {
+            std::cout << "[CyclicExecutive]: Task " << task->task_name_ << " already hosted." << std::endl;
+            return false;
+        }
+    }
+
+    if (task->rt_period_ <= 0)
+    {
+        std::cout << "[CyclicExecutive]: Task " << task->task_name_ << " has an invalid period." << std::endl;
+        return false;
+    }
+
+    task->executive_ = this;
+    tasks_.push_back({task, 1});
+    ComputeFrames();
+
+    std::cout << "[CyclicExecutive]: Task " << task->task_name_ << " hosted on " << task_name_ << std::endl;
+    return true;
+}
+
+int CyclicExecutive::Start(void *task_param)
+{
+    if (tasks_.empty())
+    {
+        std::cout << "[CyclicExecutive]: " << task_name_ << " has no hosted tasks.  Not starting." << std::endl;
+        return EINVAL;
+    }
+    return RealTimeTaskNode::Start(task_param);
+}
+
+void CyclicExecutive::ComputeFrames()
+{
+    minor_frame_ = tasks_[0].task->rt_period_;
+    major_frame_ = tasks_[0].task->rt_period_;
+    for (const Entry &entry : tasks_)
+    {
+        minor_frame_ = std::gcd(minor_frame_, entry.task->rt_period_);
+        major_frame_ = std::lcm(major_frame_, entry.task->rt_period_);
+    }
+
+    for (Entry &entry : tasks_)
+    {
+        entry.divisor = entry.task->rt_period_ / minor_frame_;
+    }
+
+    // Harmonic when every pair of periods divide each other.  Otherwise the major frame grows to the LCM
+    bool harmonic = true;
+    for (const Entry &a : tasks_)
+    {
+        for (const Entry &b : tasks_)
+        {
+            harmonic &= (a.task->rt_period_ % b.task->rt_period_ == 0) || (b.task->rt_period_ % a.task->rt_period_ == 0);
+        }
+    }
+    if (!harmonic)
+    {
+        std::cout << "[CyclicExecutive]: WARNING.  Task periods are not harmonic.  Major frame: " << major_frame_ << "us" << std::endl;
+    }
+
+    frame_index_ = 0;
+    SetTaskPeriod(minor_frame_);
+}
+
+void CyclicExecutive::SortByDependency()
+{
+    // Kahn's algorithm on the channel graph.  Task B depends on task A if one of B's inputs is mapped to one of A's outputs
+    const size_t num_tasks = tasks_.size();
+    std::vector<std::vector<size_t>> consumers(num_tasks);
+    std::vector<int> in_degree(num_tasks, 0);
+
+    for (size_t a = 0; a < num_tasks; a++)
+    {
+        for (size_t b = 0; b < num_tasks; b++)
+        {
+            if (a == b)
+                continue;
+
+            bool depends = false;
+            for (int out = 0; out < MAX_PORTS && !depends; out++)
+            {
+                std::shared_ptr<Port> output = tasks_[a].task->output_port_map_[out];
+                if (!output)
+                    continue;
+
+                for (int in = 0; in < MAX_PORTS && !depends; in++)
+                {
+                    std::shared_ptr<Port> input = tasks_[b].task->input_port_map_[in];
+                    depends = input && !input->GetChannel().empty() && input->GetChannel() == output->GetChannel();
+                }
+            }
+
+            if (depends)
+            {
+                consumers[a].push_back(b);
+                in_degree[b]++;
+            }
+        }
+    }
+
+    std::vector<Entry> sorted;
+    std::vector<bool> placed(num_tasks, false);
+    while (sorted.size() < num_tasks)
+    {
+        // Lowest insertion index with no pending producers
+        size_t next = num_tasks;
+        for (size_t i = 0; i < num_tasks; i++)
+        {
+            if (!placed[i] && in_degree[i] == 0)
+            {
+                next = i;
+                break;
+            }
+        }
+
+        // Cycle.  Break it at the earliest remaining task
+        if (next == num_tasks)
+        {
+            for (size_t i = 0; i < num_tasks && next == num_tasks; i++)
+            {
+                if (!placed[i])
+                    next = i;
+            }
+            std::cout << "[CyclicExecutive]: WARNING.  Dependency cycle at task " << tasks_[next].task->task_name_ << std::endl;
+        }
+
+        placed[next] = true;
+        sorted.push_back(tasks_[next]);
+        for (size_t consumer : consumers[next])
+        {
+            in_degree[consumer]--;
+        }
+    }
+    tasks_ = sorted;
+}
+
+void CyclicExecutive::Setup()
+{
+    for (Entry &entry : tasks_)
+    {
+        entry.task->process_id_ = process_id_;
+        entry.task->thread_id_ = thread_id_;
+        entry.task->Setup();
+        entry.task->OpenPerformanceCounters();
+    }
+
+    SortByDependency();
+    PrintSchedule();
+}
+
+void CyclicExecutive::Run()
+{
+    if (tasks_.empty() || minor_frame_ <= 0)
+        return;
+
+    const uint64_t frame_start = MonotonicNanoseconds();
+    for (Entry &entry : tasks_)
+    {
+        if (frame_index_ % entry.divisor != 0)
+            continue;
+
+        entry.task->ApplyParameterChanges();
+
+        // Hosted statistics.  Lateness is the offset of the hosted release into the minor frame
+        // Hosted span nests inside the executive's cycle span
+        const bool traced = DataflowTracer::IsEnabled();
+        DataflowTracer::Span span;
+        if (traced)
+        {
+            DataflowTracer::BeginSpan(span);
+        }
+
+        const bool account = entry.task->resource_accounting_;
+        TaskStatistics::Usage usage_start;
+        TaskStatistics::Usage usage_end;
+        if (account)
+        {
+            TaskStatistics::ReadUsage(usage_start);
+        }
+
+        const bool count = entry.task->perf_counters_.IsOpen();
+        PerfCounters::Sample perf_start;
+        PerfCounters::Sample perf_end;
+        if (count)
+        {
+            entry.task->perf_counters_.Read(perf_start);
+        }
+
+        const uint64_t run_start = MonotonicNanoseconds();
+        // Nested in the executive's own arena, which is active again after the hosted Run()
+        TaskArena *previous_arena = TaskArena::Begin(entry.task->run_arena_.get());
+        entry.task->Run();
+        TaskArena::End(previous_arena);
+        const uint64_t run_end = MonotonicNanoseconds();
+
+        if (count && entry.task->perf_counters_.Read(perf_end))
+        {
+            entry.task->perf_counters_.Record(perf_start, perf_end);
+        }
+
+        if (account)
+        {
+            TaskStatistics::ReadUsage(usage_end);
+        }
+
+        if (traced)
+        {
+            DataflowTracer::EndSpan(span, entry.task->task_name_);
+        }
+
+        const bool overrun = (run_end - run_start) > entry.task->rt_period_ * 1000ULL;
+        if (account)
+        {
+            entry.task->statistics_.Record(run_end - run_start, run_start - frame_start, overrun, usage_start, usage_end);
+        }
+        else
+        {
+            entry.task->statistics_.Record(run_end - run_start, run_start - frame_start, overrun);
+        }
+        OnTaskComplete(entry.task);
+    }
+    frame_index_ = (frame_index_ + 1) % (major_frame_ / minor_frame_);
+}
+
+void CyclicExecutive::PrintSchedule() const
+{
+    std::cout << "[CyclicExecutive]: " << task_name_ << "\tMinor Frame: " << minor_frame_ << "us\tMajor Frame: " << major_frame_ << "us" << std::endl;
+    for (const Entry &entry : tasks_)
+    {
+        std::cout << "[CyclicExecutive]: \t" << entry.task->task_name_ << "\tPeriod: " << entry.task->rt_period_
+                  << "us\tEvery " << entry.divisor << " minor frame(s)" << std::endl;
+    }
+}
+} // namespace Realtime
@@ -0,0 +1,121 @@
+/*
+ * LockstepRunner.cpp
+ *
+ *  Created on: August 21, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Realtime/LockstepRunner.hpp>
+
+#include <iostream>
+
+#include <Communications/Port.hpp>
+
+namespace Realtime
+{
+LockstepRunner::LockstepRunner(const std::string &name) : CyclicExecutive(name), initialized_(false)
+{
+}
+
+LockstepRunner::~LockstepRunner()
+{
+    // Restore the default clock
+    if (Systems::Time::GetClock() == &clock_)
+    {
+        Systems::Time::SetClock(NULL);
+    }
+}
+
+bool LockstepRunner::Initialize()
+{
+    if (initialized_)
+        return true;
+
+    if (tasks_.empty())
+    {
+        std::cout << "[LockstepRunner]: No tasks to run." << std::endl;
+        return false;
+    }
+
+    // Only INPROC messages are delivered in step.  Other transports arrive on their own threads whenever the sender
+    // gets to them, so hosted inputs on them make the run non deterministic.  Outputs on them just leave the runner
+    bool deterministic = true;
+    for (const Entry &entry : tasks_)
+    {
+        for (int i = 0; i < MAX_PORTS; i++)
+        {
+            const std::shared_ptr<Port> &input = entry.task->input_port_map_[i];
+            if (input && input->GetTransport() != Port::TransportType::INPROC)
+            {
+                std::cout << "[LockstepRunner]: Task " << entry.task->task_name_ << " input " << input->GetName() << " ("
+                          << input->GetChannel() << ") is not INPROC.  Not stepped in lockstep." << std::endl;
+                deterministic = false;
+            }
+
+            const std::shared_ptr<Port> &output = entry.task->output_port_map_[i];
+            if (output && output->GetTransport() != Port::TransportType::INPROC)
+            {
+                std::cout << "[LockstepRunner]: WARNING.  Task " << entry.task->task_name_ << " output " << output->GetName() << " ("
+                          << output->GetChannel() << ") is not INPROC.  Published on simulated time, delivered in real time." << std::endl;
+            }
+        }
+    }
+
+    if (!deterministic)
+    {
+        std::cout << "[LockstepRunner]: Map hosted inputs to INPROC ports." << std::endl;
+        return false;
+    }
+
+    clock_.Set(0);
+    Systems::Time::SetClock(&clock_);
+
+    // Hosted setup and dependency ordering
+    Setup();
+    initialized_ = true;
+    return true;
+}
+
+bool LockstepRunner::Step()
+{
+    // Nothing hosted.  No frame to step
+    if (!Initialize())
+        return false;
+
+    Run();
+    clock_.Advance(minor_frame_);
+    return true;
+}
+
+uint64_t LockstepRunner::RunFor(const uint64_t duration)
+{
+    const uint64_t end_time = clock_.Now() + duration;
+    uint64_t frames = 0;
+    while (clock_.Now() < end_time && Step())
+    {
+        frames++;
+    }
+    return frames;
+}
+
+void LockstepRunner::OnTaskComplete(RealTimeTaskNode *task)
+{
+    PortManager::Instance()->GetInprocContext()->flush();
+}
+} // namespace Realtime
@@ -0,0 +1,370 @@
+/*
+ * ParameterStore.cpp
+ *
+ *  Created on: September 5, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <Realtime/ParameterStore.hpp>
+
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace Realtime
+{
+namespace
+{
+// Reader slot of the calling thread.  Released when the thread exits
+struct ThreadReader
+{
+    int slot;
+    int depth;
+
+    ThreadReader() : slot(-1), depth(0) {}
+    ~ThreadReader();
+};
+
+thread_local ThreadReader thread_reader;
+
+std::string Trim(const std::string &text)
+{
+    const size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+        return "";
+    const size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+} // namespace
+
+ParameterStore *ParameterStore::Instance()
+{
+    // Thread safe on first use.  Never destroyed so exiting task threads can still release their slots
+    static ParameterStore *instance = new ParameterStore();
+    return instance;
+}
+
+ParameterStore::ParameterStore() : current_(new Snapshot()),
+                                   version_(0),
+                                   epoch_(1)
+{
+    current_.load()->version = 0;
+    for (int i = 0; i < MAX_READERS; i++)
+    {
+        readers_[i].epoch = 0;
+        readers_[i].in_use = false;
+    }
+}
+
+ThreadReader::~ThreadReader()
+{
+    ParameterStore::UnregisterThread();
+}
+
+void ParameterStore::RegisterThread()
+{
+    if (thread_reader.slot >= 0)
+        return;
+
+    ParameterStore *store = Instance();
+    for (int i = 0; i < MAX_READERS; i++)
+    {
+        bool expected = false;
+        if (store->readers_[i].in_use.compare_exchange_strong(expected, true))
+        {
+            store->readers_[i].epoch = 0;
+            thread_reader.slot = i;
+            return;
+        }
+    }
+
+    // An untracked reader could see a snapshot freed under it, and locking instead would block the reader behind
+    // updates.  Neither is acceptable on a task thread, so stop here rather than run without a slot
+    std::cerr << "[ParameterStore]: Out of reader slots (" << MAX_READERS << ").  Raise MAX_READERS." << std::endl;
+    abort();
+}
+
+void ParameterStore::UnregisterThread()
+{
+    if (thread_reader.slot < 0)
+        return;
+
+    ParameterStore *store = Instance();
+    store->readers_[thread_reader.slot].epoch = 0;
+    store->readers_[thread_reader.slot].in_use = false;
+    thread_reader.slot = -1;
+}
+
+const ParameterStore::Snapshot *ParameterStore::Enter()
+{
+    if (thread_reader.depth++ == 0)
+    {
+        if (thread_reader.slot < 0)
+        {
+            RegisterThread();
+        }
+
+        // Announce the entry epoch before loading the snapshot.  An updater that swaps after this load waits for us
+        readers_[thread_reader.slot].epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+    return current_.load(std::memory_order_seq_cst);
+}
+
+void ParameterStore::Leave()
+{
+    if (--thread_reader.depth != 0)
+        return;
+
+    readers_[thread_reader.slot].epoch.store(0, std::memory_order_release);
+}
+
+ParameterStore::ReadGuard::ReadGuard() : snapshot_(ParameterStore::Instance()->Enter())
+{
+}
+
+ParameterStore::ReadGuard::~ReadGuard()
+{
+    ParameterStore::Instance()->Leave();
+}
+
+ParameterStore::Snapshot *ParameterStore::CopyCurrent() const
+{
+    Snapshot *snapshot = new Snapshot(*current_.load(std::memory_order_acquire));
+    snapshot->version++;
+    return snapshot;
+}
+
+void ParameterStore::Publish(Snapshot *snapshot, const std::vector<std::string> &changed, std::unique_lock<std::mutex> &lck)
+{
+    Snapshot *previous = current_.exchange(snapshot, std::memory_order_seq_cst);
+    const uint64_t retired_at = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    version_.store(snapshot->version, std::memory_order_release);
+
+    retired_.push_back(std::make_pair(previous, retired_at));
+    Reclaim();
+
+    // Hooks run without the lock so they may read or update the store
+    std::vector<std::pair<std::string, std::function<void(const std::string &)>>> hooks;
+    for (const std::string &name : changed)
+    {
+        auto range = hooks_.equal_range(names_[name]);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            hooks.push_back(std::make_pair(name, it->second));
+        }
+    }
+    lck.unlock();
+
+    for (const auto &hook : hooks)
+    {
+        hook.second(hook.first);
+    }
+}
+
+void ParameterStore::Reclaim()
+{
+    // Oldest epoch a reader is still inside
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < MAX_READERS; i++)
+    {
+        const uint64_t epoch = readers_[i].epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+
+    // A reader that entered at or after the retire epoch loaded the newer snapshot
+    size_t kept = 0;
+    for (size_t i = 0; i < retired_.size(); i++)
+    {
+        if (retired_[i].second <= oldest)
+            delete retired_[i].first;
+        else
+            retired_[kept++] = retired_[i];
+    }
+    retired_.resize(kept);
+}
+
+bool ParameterStore::Parse(const std::string &text, Value &value)
+{
+    // Value is left untouched on error
+    const std::string trimmed = Trim(text);
+    char *end = NULL;
+    switch (value.type)
+    {
+    case DOUBLE:
+    {
+        const double number = strtod(trimmed.c_str(), &end);
+        if (trimmed.empty() || *end != '\0')
+            return false;
+        value.number = number;
+        return true;
+    }
+    case INTEGER:
+    {
+        const int64_t integer = strtoll(trimmed.c_str(), &end, 10);
+        if (trimmed.empty() || *end != '\0')
+            return false;
+        value.integer = integer;
+        return true;
+    }
+    case BOOLEAN:
+        if (trimmed == "true" || trimmed == "1")
+            value.flag = true;
+        else if (trimmed == "false" || trimmed == "0")
+            value.flag = false;
+        else
+            return false;
+        return true;
+    case VECTOR:
+    {
+        std::vector<double> vector;
+        std::stringstream stream(trimmed);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            item = Trim(item);
+            vector.push_back(strtod(item.c_str(), &end));
+            if (item.empty() || *end != '\0')
+                return false;
+        }
+        value.vector = vector;
+        return true;
+    }
+    }
+    return false;
+}
+
+std::string ParameterStore::Format(const Value &value)
+{
+    std::ostringstream text;
+    switch (value.type)
+    {
+    case DOUBLE:
+        text << value.number;
+        break;
+    case INTEGER:
+        text << value.integer;
+        break;
+    case BOOLEAN:
+        text << (value.flag ? "true" : "false");
+        break;
+    case VECTOR:
+        for (size_t i = 0; i < value.vector.size(); i++)
+            text << (i ? "," : "") << value.vector[i];
+        break;
+    }
+    return text.str();
+}
+
+void ParameterStore::WarnDefault(const std::string &name, const Value &first, const Value &declared)
+{
+    std::cout << "[ParameterStore]: WARNING: " << name << " declared again with default " << Format(declared)
+              << ".  Keeping default " << Format(first) << " from its first declaration." << std::endl;
+}
+
+bool ParameterStore::Set(const std::string &name, const std::string &value)
+{
+    std::unique_lock<std::mutex> lck(write_mutex_);
+    auto it = names_.find(name);
+    if (it == names_.end())
+    {
+        std::cout << "[ParameterStore]: No parameter " << name << std::endl;
+        return false;
+    }
+
+    Snapshot *snapshot = CopyCurrent();
+    Value &entry = snapshot->values[it->second];
+    if (!Parse(value, entry))
+    {
+        std::cout << "[ParameterStore]: Invalid value for " << name << ": " << value << std::endl;
+        delete snapshot;
+        return false;
+    }
+    entry.version = snapshot->version;
+
+    std::cout << "[ParameterStore]: " << name << " = " << Format(entry) << std::endl;
+    Publish(snapshot, std::vector<std::string>(1, name), lck);
+    return true;
+}
+
+bool ParameterStore::Load(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "[ParameterStore]: Failed to open " << path << std::endl;
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lck(write_mutex_);
+    Snapshot *snapshot = CopyCurrent();
+    std::vector<std::string> changed;
+    bool result = true;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        const size_t split = line.find_first_of(" \t");
+        const std::string name = line.substr(0, split);
+        const std::string value = split == std::string::npos ? "" : line.substr(split);
+        auto it = names_.find(name);
+        if (it == names_.end() || !Parse(value, snapshot->values[it->second]))
+        {
+            std::cout << "[ParameterStore]: " << path << ": Skipping \"" << line << "\"" << std::endl;
+            result = false;
+            continue;
+        }
+        snapshot->values[it->second].version = snapshot->version;
+        changed.push_back(name);
+    }
+
+    // Every line lands in one snapshot, so readers never see half a file
+    std::cout << "[ParameterStore]: Loaded " << changed.size() << " parameters from " << path << std::endl;
+    Publish(snapshot, changed, lck);
+    return result;
+}
+
+void ParameterStore::AddHook(const std::string &name, const std::function<void(const std::string &)> &hook)
+{
+    std::unique_lock<std::mutex> lck(write_mutex_);
+    auto it = names_.find(name);
+    if (it == names_.end())
+    {
+        std::cout << "[ParameterStore]: No parameter " << name << " to hook" << std::endl;
+        return;
+    }
+    hooks_.insert(std::make_pair(it->second, hook));
+}
+
+void ParameterStore::Print() const
+{
+    std::unique_lock<std::mutex> lck(write_mutex_);
+    const Snapshot *snapshot = current_.load(std::memory_order_acquire);
+    std::cout << "[ParameterStore]: Version: " << snapshot->version << "\tParameters: " << names_.size() << "\tRetired Snapshots: " << retired_.size() << std::endl;
+    for (const auto &name : names_)
+    {
+        std::cout << "[ParameterStore]: \t" << name.first << " = " << Format(snapshot->values[name.second]) << std::endl;
+    }
+}
+} // namespace Realtime
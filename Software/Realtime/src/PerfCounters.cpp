@@ -0,0 +1,225 @@
+/*
+ * PerfCounters.cpp
+ *
+ *  Created on: September 6, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <Realtime/PerfCounters.hpp>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+namespace Realtime
+{
+// Group read layout for PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+struct GroupRead
+{
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    struct
+    {
+        uint64_t value;
+        uint64_t id;
+    } values[PerfCounters::NUM_COUNTERS];
+};
+
+static int PerfEventOpen(struct perf_event_attr *attr, const int group_fd)
+{
+    // This thread, any CPU
+    return syscall(SYS_perf_event_open, attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+PerfCounters::PerfCounters() : leader_fd_(-1),
+                               samples_(0),
+                               multiplexed_samples_(0)
+{
+    for (int i = 0; i < NUM_COUNTERS; i++)
+    {
+        fds_[i] = -1;
+        ids_[i] = 0;
+        available_[i] = false;
+        totals_[i] = 0;
+        max_[i] = 0;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    Close();
+}
+
+bool PerfCounters::OpenCounter(const Counter counter, const uint32_t type, const uint64_t config, const bool user_only)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = user_only;
+    attr.exclude_hv = 1;
+    attr.disabled = leader_fd_ < 0; // Leader starts the group
+
+    const int fd = PerfEventOpen(&attr, leader_fd_);
+    if (fd < 0)
+        return false;
+
+    uint64_t id = 0;
+    if (ioctl(fd, PERF_EVENT_IOC_ID, &id) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    if (leader_fd_ < 0)
+        leader_fd_ = fd;
+    fds_[counter] = fd;
+    ids_[counter] = id;
+    available_[counter] = true;
+    return true;
+}
+
+bool PerfCounters::Open()
+{
+    if (IsOpen())
+        return true;
+
+    // Hardware group led by cycles.  The rest are optional, some PMUs lack generic cache or branch events
+    if (OpenCounter(CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true))
+    {
+        OpenCounter(INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, true);
+        OpenCounter(CACHE_REFERENCES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, true);
+        OpenCounter(CACHE_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, true);
+        OpenCounter(BRANCHES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, true);
+        OpenCounter(BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, true);
+    }
+
+    // Software counters.  Lead the group themselves without a PMU.  Switches and migrations happen in the kernel, so
+    // these count kernel side
+    OpenCounter(TASK_CLOCK, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, false);
+    OpenCounter(CONTEXT_SWITCHES, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false);
+    OpenCounter(CPU_MIGRATIONS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, false);
+    OpenCounter(PAGE_FAULTS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, false);
+
+    if (leader_fd_ < 0)
+        return false;
+
+    ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::Close()
+{
+    // Members first, then the leader
+    for (int i = NUM_COUNTERS - 1; i >= 0; i--)
+    {
+        if (fds_[i] >= 0 && fds_[i] != leader_fd_)
+            close(fds_[i]);
+    }
+    if (leader_fd_ >= 0)
+        close(leader_fd_);
+
+    leader_fd_ = -1;
+    for (int i = 0; i < NUM_COUNTERS; i++)
+    {
+        fds_[i] = -1;
+        ids_[i] = 0;
+    }
+}
+
+bool PerfCounters::Read(Sample &sample) const
+{
+    GroupRead group;
+    const ssize_t size = read(leader_fd_, &group, sizeof(group));
+    if (size < (ssize_t)(3 * sizeof(uint64_t)))
+        return false;
+
+    sample.time_enabled = group.time_enabled;
+    sample.time_running = group.time_running;
+    for (int i = 0; i < NUM_COUNTERS; i++)
+        sample.values[i] = 0;
+
+    for (uint64_t i = 0; i < group.nr && i < NUM_COUNTERS; i++)
+    {
+        for (int counter = 0; counter < NUM_COUNTERS; counter++)
+        {
+            if (available_[counter] && ids_[counter] == group.values[i].id)
+            {
+                sample.values[counter] = group.values[i].value;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+void PerfCounters::Record(const Sample &start, const Sample &end)
+{
+    // Group was scheduled off the PMU for part of the window.  Counts cover the running part only
+    if (end.time_running - start.time_running < end.time_enabled - start.time_enabled)
+        multiplexed_samples_.store(multiplexed_samples_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    for (int i = 0; i < NUM_COUNTERS; i++)
+    {
+        const uint64_t delta = end.values[i] - start.values[i];
+        totals_[i].store(totals_[i].load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        if (delta > max_[i].load(std::memory_order_relaxed))
+            max_[i].store(delta, std::memory_order_relaxed);
+    }
+
+    // Publishes the counter set opened on this thread to readers
+    samples_.store(samples_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void PerfCounters::Reset()
+{
+    samples_ = 0;
+    multiplexed_samples_ = 0;
+    for (int i = 0; i < NUM_COUNTERS; i++)
+    {
+        totals_[i] = 0;
+        max_[i] = 0;
+    }
+}
+
+void PerfCounters::GetSnapshot(Snapshot &snapshot) const
+{
+    snapshot.samples = samples_.load(std::memory_order_acquire);
+    snapshot.multiplexed_samples = multiplexed_samples_.load(std::memory_order_relaxed);
+    for (int i = 0; i < NUM_COUNTERS; i++)
+    {
+        snapshot.totals[i] = totals_[i].load(std::memory_order_relaxed);
+        snapshot.max[i] = max_[i].load(std::memory_order_relaxed);
+        snapshot.available[i] = available_[i];
+    }
+}
+
+const char *PerfCounters::Name(const Counter counter)
+{
+    static const char *names[NUM_COUNTERS] = {"Cycles", "Instructions", "Cache References", "Cache Misses", "Branches",
+                                              "Branch Misses", "Task Clock", "Context Switches", "CPU Migrations", "Page Faults"};
+    return counter < NUM_COUNTERS ? names[counter] : "Unknown";
+}
+} // namespace Realtime
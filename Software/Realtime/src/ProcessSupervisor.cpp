@@ -0,0 +1,501 @@
+/*
+ * ProcessSupervisor.cpp
+ *
+ *  Created on: September 4, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <Realtime/ProcessSupervisor.hpp>
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace Realtime
+{
+static uint64_t MonotonicNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// cgroup files take one write per value.  Errors are reported on the write
+static bool WriteFile(const std::string &path, const std::string &value)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    file << value;
+    file.flush();
+    return file.good();
+}
+
+static std::string ReadFile(const std::string &path)
+{
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Value of a "key value" line of a flat keyed file (cpu.stat)
+static std::string ReadKey(const std::string &contents, const std::string &key)
+{
+    std::istringstream stream(contents);
+    std::string name, value;
+    while (stream >> name >> value)
+    {
+        if (name == key)
+            return value;
+    }
+    return "0";
+}
+
+// Supervisor signals.  Blocked and taken with sigtimedwait()
+static void ShutdownSignals(sigset_t &set, const bool child_signal)
+{
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    if (child_signal)
+        sigaddset(&set, SIGCHLD);
+}
+
+ProcessSupervisor::GroupConfig::GroupConfig() : isolated(false),
+                                                cpu_quota_us(0),
+                                                cpu_period_us(100000),
+                                                cpu_weight(0),
+                                                restart(RESTART_NEVER),
+                                                max_restarts(-1),
+                                                restart_delay_ms(1000),
+                                                critical(false)
+{
+}
+
+ProcessSupervisor::ProcessSupervisor(const std::string &name,
+                                     const std::string &cgroup_root) : name_(name),
+                                                                       cgroup_root_(cgroup_root),
+                                                                       cgroups_enabled_(false),
+                                                                       supervisor_pid_(getpid()),
+                                                                       stop_timeout_ms_(2000),
+                                                                       started_(false),
+                                                                       failed_(false)
+{
+}
+
+ProcessSupervisor::~ProcessSupervisor()
+{
+    Stop();
+}
+
+bool ProcessSupervisor::AddGroup(const std::string &name, const std::function<int()> &entry, const GroupConfig &config)
+{
+    if (started_)
+    {
+        std::cout << "[ProcessSupervisor]: Cannot add group " << name << " after Start()" << std::endl;
+        return false;
+    }
+
+    Group group;
+    group.name = name;
+    group.entry = entry;
+    group.config = config;
+    group.pid = -1;
+    group.restarts = 0;
+    group.restart_at_ns = 0;
+    group.exit_status = 0;
+    groups_.push_back(group);
+    return true;
+}
+
+bool ProcessSupervisor::AddGroup(const std::string &name, const std::vector<std::string> &argv, const GroupConfig &config)
+{
+    if (argv.empty())
+    {
+        std::cout << "[ProcessSupervisor]: Group " << name << " has no command" << std::endl;
+        return false;
+    }
+
+    if (!AddGroup(name, std::function<int()>(), config))
+        return false;
+
+    groups_.back().argv = argv;
+    return true;
+}
+
+bool ProcessSupervisor::Start()
+{
+    if (started_)
+        return true;
+
+    // Signals arrive at sigtimedwait() in Run().  Blocked before any group is forked so children inherit the mask
+    sigset_t set;
+    ShutdownSignals(set, true);
+    sigprocmask(SIG_BLOCK, &set, NULL);
+
+    cgroups_enabled_ = access((cgroup_root_ + "/cgroup.controllers").c_str(), F_OK) == 0;
+    if (!cgroups_enabled_)
+    {
+        std::cout << "[ProcessSupervisor]: No cgroup v2 hierarchy at " << cgroup_root_ << ".  Groups run without cpusets or CPU limits." << std::endl;
+    }
+    else
+    {
+        // Controllers for the group cgroups.  cpu fails with real time threads outside the root on RT_GROUP_SCHED kernels
+        if (!WriteFile(cgroup_root_ + "/cgroup.subtree_control", "+cpuset"))
+            std::cout << "[ProcessSupervisor]: Failed to enable the cpuset controller in " << cgroup_root_ << std::endl;
+        if (!WriteFile(cgroup_root_ + "/cgroup.subtree_control", "+cpu"))
+            std::cout << "[ProcessSupervisor]: Failed to enable the cpu controller in " << cgroup_root_ << std::endl;
+    }
+
+    for (Group &group : groups_)
+    {
+        if (cgroups_enabled_)
+            SetupCgroup(group);
+    }
+
+    started_ = true;
+    failed_ = false;
+    bool result = true;
+    for (Group &group : groups_)
+    {
+        result &= Launch(group);
+    }
+    return result;
+}
+
+bool ProcessSupervisor::SetupCgroup(Group &group)
+{
+    group.cgroup_path = cgroup_root_ + "/" + name_ + "." + group.name;
+    if (mkdir(group.cgroup_path.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        std::cout << "[ProcessSupervisor]: Group " << group.name << " failed to create " << group.cgroup_path << ": " << strerror(errno) << std::endl;
+        group.cgroup_path.clear();
+        return false;
+    }
+
+    const GroupConfig &config = group.config;
+    bool result = true;
+    auto apply = [&](const std::string &file, const std::string &value) {
+        if (!WriteFile(group.cgroup_path + "/" + file, value))
+        {
+            std::cout << "[ProcessSupervisor]: Group " << group.name << " failed to set " << file << " = " << value << std::endl;
+            result = false;
+        }
+    };
+
+    if (!config.cpus.empty())
+        apply("cpuset.cpus", config.cpus);
+    if (!config.mems.empty())
+        apply("cpuset.mems", config.mems);
+    if (config.isolated)
+        apply("cpuset.cpus.partition", "isolated");
+
+    const std::string quota = config.cpu_quota_us > 0 ? std::to_string(config.cpu_quota_us) : "max";
+    apply("cpu.max", quota + " " + std::to_string(config.cpu_period_us));
+    if (config.cpu_weight > 0)
+        apply("cpu.weight", std::to_string(config.cpu_weight));
+
+    return result;
+}
+
+void ProcessSupervisor::RemoveCgroups()
+{
+    for (Group &group : groups_)
+    {
+        if (group.cgroup_path.empty() || group.pid > 0)
+            continue;
+
+        if (rmdir(group.cgroup_path.c_str()) != 0 && errno != ENOENT)
+        {
+            std::cout << "[ProcessSupervisor]: Failed to remove " << group.cgroup_path << ": " << strerror(errno) << std::endl;
+        }
+        group.cgroup_path.clear();
+    }
+}
+
+bool ProcessSupervisor::Launch(Group &group)
+{
+    // Flush so buffered output is not written twice
+    std::cout << std::flush;
+    fflush(NULL);
+
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cout << "[ProcessSupervisor]: Group " << group.name << " failed to fork: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        RunChild(group);
+    }
+
+    group.pid = pid;
+    group.restart_at_ns = 0;
+    std::cout << "[ProcessSupervisor]: Group " << group.name << " STARTED.  PID: " << pid
+              << "\tCPUs: " << (group.config.cpus.empty() ? "All" : group.config.cpus)
+              << "\tCPU Limit: " << (group.config.cpu_quota_us > 0 ? std::to_string(100 * group.config.cpu_quota_us / group.config.cpu_period_us) + "%" : "None")
+              << std::endl;
+    return true;
+}
+
+void ProcessSupervisor::RunChild(Group &group)
+{
+    // Go down with the supervisor
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() != supervisor_pid_)
+        _exit(1);
+
+    prctl(PR_SET_NAME, group.name.substr(0, 15).c_str());
+
+    // Join the cgroup while single threaded so every thread created later is in it
+    if (!group.cgroup_path.empty() && !WriteFile(group.cgroup_path + "/cgroup.procs", std::to_string(getpid())))
+    {
+        std::cout << "[ProcessSupervisor]: Group " << group.name << " failed to join " << group.cgroup_path << ".  Running without its cpuset/limits." << std::endl;
+    }
+
+    sigset_t set;
+    if (!group.argv.empty())
+    {
+        // The signal mask survives exec.  Hand the program a clean one
+        sigemptyset(&set);
+        sigprocmask(SIG_SETMASK, &set, NULL);
+
+        std::vector<char *> argv;
+        for (const std::string &arg : group.argv)
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        argv.push_back(NULL);
+
+        execvp(argv[0], argv.data());
+        std::cout << "[ProcessSupervisor]: Group " << group.name << " failed to run " << group.argv[0] << ": " << strerror(errno) << std::endl;
+        _exit(127);
+    }
+
+    // SIGINT/SIGTERM stay blocked for WaitForShutdown()
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigprocmask(SIG_UNBLOCK, &set, NULL);
+
+    const int result = group.entry ? group.entry() : 0;
+    std::cout << std::flush;
+    exit(result);
+}
+
+bool ProcessSupervisor::Reap()
+{
+    bool result = true;
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        for (Group &group : groups_)
+        {
+            if (group.pid != pid)
+                continue;
+
+            group.pid = -1;
+            group.exit_status = status;
+
+            const bool clean = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (WIFSIGNALED(status))
+                std::cout << "[ProcessSupervisor]: Group " << group.name << " KILLED by signal " << WTERMSIG(status) << " (" << strsignal(WTERMSIG(status)) << ")" << std::endl;
+            else
+                std::cout << "[ProcessSupervisor]: Group " << group.name << " EXITED with status " << WEXITSTATUS(status) << std::endl;
+
+            if (!clean)
+                failed_ = true;
+
+            if (group.config.critical)
+            {
+                std::cout << "[ProcessSupervisor]: Group " << group.name << " is critical.  Shutting down." << std::endl;
+                result = false;
+                break;
+            }
+
+            const bool restart = group.config.restart == RESTART_ALWAYS || (group.config.restart == RESTART_ON_FAILURE && !clean);
+            if (!restart)
+                break;
+
+            if (group.config.max_restarts >= 0 && group.restarts >= group.config.max_restarts)
+            {
+                std::cout << "[ProcessSupervisor]: Group " << group.name << " restarted " << group.restarts << " times.  Giving up." << std::endl;
+                break;
+            }
+            group.restart_at_ns = MonotonicNanoseconds() + group.config.restart_delay_ms * 1000000ULL;
+            break;
+        }
+    }
+    return result;
+}
+
+int ProcessSupervisor::Run()
+{
+    if (!started_ && !Start())
+        return 1;
+
+    sigset_t set;
+    ShutdownSignals(set, true);
+
+    while (true)
+    {
+        // Pending restarts
+        bool active = false;
+        const uint64_t now = MonotonicNanoseconds();
+        for (Group &group : groups_)
+        {
+            if (group.pid < 0 && group.restart_at_ns != 0 && now >= group.restart_at_ns)
+            {
+                group.restarts++;
+                if (!Launch(group))
+                    group.restart_at_ns = now + group.config.restart_delay_ms * 1000000ULL;
+            }
+            active |= group.pid > 0 || group.restart_at_ns != 0;
+        }
+
+        if (!active)
+            break;
+
+        struct timespec timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_nsec = 100000000; // Restart check interval
+        siginfo_t info;
+        const int signal = sigtimedwait(&set, &info, &timeout);
+        if (signal == SIGINT || signal == SIGTERM)
+        {
+            std::cout << "[ProcessSupervisor]: " << strsignal(signal) << ".  Stopping all groups." << std::endl;
+            Stop();
+            return failed_ ? 1 : 0;
+        }
+
+        if (!Reap())
+        {
+            failed_ = true;
+            Stop();
+            return 1;
+        }
+    }
+
+    RemoveCgroups();
+    return failed_ ? 1 : 0;
+}
+
+void ProcessSupervisor::Stop()
+{
+    if (!started_)
+        return;
+
+    for (Group &group : groups_)
+    {
+        group.restart_at_ns = 0;
+        if (group.pid > 0)
+            kill(group.pid, SIGTERM);
+    }
+
+    // Grace period, then kill what is left
+    const uint64_t deadline = MonotonicNanoseconds() + stop_timeout_ms_ * 1000000ULL;
+    bool running = true;
+    while (running)
+    {
+        running = false;
+        for (Group &group : groups_)
+        {
+            if (group.pid <= 0)
+                continue;
+
+            int status;
+            if (waitpid(group.pid, &status, WNOHANG) == group.pid)
+            {
+                group.pid = -1;
+                group.exit_status = status;
+                continue;
+            }
+
+            if (MonotonicNanoseconds() < deadline)
+            {
+                running = true;
+                continue;
+            }
+
+            std::cout << "[ProcessSupervisor]: Group " << group.name << " did not stop.  Killing." << std::endl;
+            kill(group.pid, SIGKILL);
+            waitpid(group.pid, &status, 0);
+            group.pid = -1;
+            group.exit_status = status;
+        }
+
+        if (running)
+            usleep(10000);
+    }
+
+    RemoveCgroups();
+    started_ = false;
+    std::cout << "[ProcessSupervisor]: " << name_ << " STOPPED." << std::endl;
+}
+
+void ProcessSupervisor::PrintStatus() const
+{
+    std::cout << "[ProcessSupervisor]: " << name_ << "\tGroups: " << groups_.size() << "\tCgroups: " << (cgroups_enabled_ ? cgroup_root_ : "None") << std::endl;
+    for (const Group &group : groups_)
+    {
+        std::cout << "[ProcessSupervisor]: \t" << group.name << "\tPID: " << group.pid
+                  << "\tState: " << (group.pid > 0 ? "Running" : (group.restart_at_ns != 0 ? "Restarting" : "Stopped"))
+                  << "\tRestarts: " << group.restarts;
+
+        if (!group.cgroup_path.empty())
+        {
+            // Usage and throttling of SCHED_OTHER threads against cpu.max
+            std::string cpus = ReadFile(group.cgroup_path + "/cpuset.cpus.effective");
+            if (!cpus.empty() && cpus.back() == '\n')
+                cpus.pop_back();
+            const std::string stat = ReadFile(group.cgroup_path + "/cpu.stat");
+            std::cout << "\tCPUs: " << cpus
+                      << "\tCPU Time: " << ReadKey(stat, "usage_usec") << "us"
+                      << "\tThrottled: " << ReadKey(stat, "nr_throttled") << "/" << ReadKey(stat, "nr_periods") << " periods, "
+                      << ReadKey(stat, "throttled_usec") << "us";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int ProcessSupervisor::WaitForShutdown()
+{
+    sigset_t set;
+    ShutdownSignals(set, false);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    int signal = 0;
+    while (sigwait(&set, &signal) != 0)
+    {
+    }
+    return signal;
+}
+} // namespace Realtime
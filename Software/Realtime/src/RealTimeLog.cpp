@@ -0,0 +1,338 @@
+/*
+ * RealTimeLog.cpp
+ *
+ *  Created on: August 26, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Primary Include
+#include <Realtime/RealTimeLog.hpp>
+
+// C System Includes
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+// C++ System Includes
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Realtime
+{
+namespace
+{
+// Single producer (owning thread), single consumer (drain, under drain_mutex)
+struct Ring
+{
+    std::vector<RealTimeLog::Record> records;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head; // Written by producer
+    alignas(64) std::atomic<size_t> tail; // Written by consumer
+    std::atomic<uint64_t> dropped;
+    std::atomic_bool released; // Owning thread exited.  Freed by the drain once empty
+};
+
+// Heap allocated and never freed so logging from static destructors stays valid
+struct LogState
+{
+    std::mutex registry_mutex;
+    std::vector<Ring *> rings;
+    uint64_t released_dropped; // Drops of rings already freed.  Under registry_mutex
+    std::mutex drain_mutex;
+    std::thread drain_thread;
+    std::atomic_bool running;
+    bool started;
+    uint64_t reported_drops;
+    std::vector<RealTimeLog::Record> pending;
+};
+
+LogState &State()
+{
+    static LogState *state = new LogState();
+    return *state;
+}
+
+thread_local Ring *thread_ring = NULL;
+
+// Set once the thread's ring is handed back.  Later records from the exiting thread are dropped
+thread_local bool thread_ring_released = false;
+
+// Hands the calling thread's ring to the drain at thread exit
+struct RingOwner
+{
+    ~RingOwner()
+    {
+        if (thread_ring == NULL)
+            return;
+
+        // Release pairs with the acquire in Drain(), so every committed record is visible once this is seen
+        thread_ring->released.store(true, std::memory_order_release);
+        thread_ring = NULL;
+        thread_ring_released = true;
+    }
+};
+
+thread_local RingOwner ring_owner;
+
+// Drain pass interval
+const int DRAIN_PERIOD_US = 2000;
+
+void Format(const RealTimeLog::Record &record, std::string &line)
+{
+    int arg = 0;
+    char number[32];
+    for (const char *c = record.format; *c != '\0'; c++)
+    {
+        if (c[0] != '{' || c[1] != '}' || arg >= record.num_args)
+        {
+            line += *c;
+            continue;
+        }
+
+        const RealTimeLog::Arg &value = record.args[arg++];
+        if (value.type == RealTimeLog::ArgType::INT)
+            snprintf(number, sizeof(number), "%lld", (long long)value.i);
+        else if (value.type == RealTimeLog::ArgType::UINT)
+            snprintf(number, sizeof(number), "%llu", (unsigned long long)value.u);
+        else if (value.type == RealTimeLog::ArgType::DOUBLE)
+            snprintf(number, sizeof(number), "%g", value.d);
+
+        if (value.type == RealTimeLog::ArgType::STRING)
+            line.append(record.text + value.s.offset, value.s.length);
+        else
+            line += number;
+        c++;
+    }
+    line += '\n';
+}
+
+// Collect, order and write everything pending.  Caller holds drain_mutex
+void Drain()
+{
+    LogState &state = State();
+    state.pending.clear();
+
+    uint64_t dropped = 0;
+    {
+        std::unique_lock<std::mutex> lck(state.registry_mutex);
+        size_t kept = 0;
+        for (Ring *ring : state.rings)
+        {
+            // Released before the head is read, so a released ring is empty after this pass
+            const bool released = ring->released.load(std::memory_order_acquire);
+            const size_t head = ring->head.load(std::memory_order_acquire);
+            size_t tail = ring->tail.load(std::memory_order_relaxed);
+            for (; tail != head; tail++)
+            {
+                state.pending.push_back(ring->records[tail & ring->mask]);
+            }
+            ring->tail.store(tail, std::memory_order_release);
+
+            if (released)
+            {
+                state.released_dropped += ring->dropped.load(std::memory_order_relaxed);
+                delete ring;
+                continue;
+            }
+            dropped += ring->dropped.load(std::memory_order_relaxed);
+            state.rings[kept++] = ring;
+        }
+        state.rings.resize(kept);
+        dropped += state.released_dropped;
+    }
+
+    if (state.pending.empty() && dropped == state.reported_drops)
+        return;
+
+    // Interleave threads in time order
+    std::stable_sort(state.pending.begin(), state.pending.end(), [](const RealTimeLog::Record &a, const RealTimeLog::Record &b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+
+    std::string text;
+    for (const RealTimeLog::Record &record : state.pending)
+    {
+        Format(record, text);
+    }
+
+    if (dropped != state.reported_drops)
+    {
+        text += "[RealTimeLog]: Dropped " + std::to_string(dropped - state.reported_drops) + " records.  Log ring full!\n";
+        state.reported_drops = dropped;
+    }
+
+    std::cout << text << std::flush;
+}
+
+void DrainLoop()
+{
+    // Inherit nothing from a real time creator.  Drain runs time sharing at low priority
+    struct sched_param param;
+    param.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), 10);
+
+    LogState &state = State();
+    while (state.running.load(std::memory_order_relaxed))
+    {
+        {
+            std::unique_lock<std::mutex> lck(state.drain_mutex);
+            Drain();
+        }
+        usleep(DRAIN_PERIOD_US);
+    }
+}
+
+void StopAtExit()
+{
+    RealTimeLog::Stop();
+}
+} // namespace
+
+void RealTimeLog::RegisterThread(const size_t capacity)
+{
+    if (thread_ring != NULL || thread_ring_released)
+        return;
+
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    Ring *ring = new Ring();
+    ring->records.resize(size);
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->released = false;
+
+    {
+        LogState &state = State();
+        std::unique_lock<std::mutex> lck(state.registry_mutex);
+        state.rings.push_back(ring);
+    }
+    thread_ring = ring;
+
+    // Constructs the thread's owner, so its destructor hands the ring back at thread exit
+    (void)&ring_owner;
+
+    Start();
+}
+
+void RealTimeLog::Start()
+{
+    LogState &state = State();
+    std::unique_lock<std::mutex> lck(state.drain_mutex);
+    if (state.started)
+        return;
+
+    state.started = true;
+    state.running = true;
+    state.drain_thread = std::thread(DrainLoop);
+    static bool registered = false;
+    if (!registered)
+    {
+        atexit(StopAtExit);
+        registered = true;
+    }
+}
+
+void RealTimeLog::Stop()
+{
+    LogState &state = State();
+    {
+        std::unique_lock<std::mutex> lck(state.drain_mutex);
+        if (!state.started)
+            return;
+        state.running = false;
+    }
+
+    if (state.drain_thread.joinable())
+    {
+        state.drain_thread.join();
+    }
+
+    std::unique_lock<std::mutex> lck(state.drain_mutex);
+    state.started = false;
+    Drain();
+}
+
+void RealTimeLog::Flush()
+{
+    LogState &state = State();
+    std::unique_lock<std::mutex> lck(state.drain_mutex);
+    Drain();
+}
+
+uint64_t RealTimeLog::GetDropped()
+{
+    LogState &state = State();
+    std::unique_lock<std::mutex> lck(state.registry_mutex);
+
+    uint64_t dropped = state.released_dropped;
+    for (Ring *ring : state.rings)
+    {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+RealTimeLog::Record *RealTimeLog::Reserve()
+{
+    if (thread_ring == NULL)
+    {
+        // Thread exiting.  Its ring is gone
+        if (thread_ring_released)
+            return NULL;
+
+        // Late registration allocates.  RealTimeTaskNode registers before its loop
+        RegisterThread();
+    }
+
+    Ring *ring = thread_ring;
+    const size_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) > ring->mask)
+    {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    Record *record = &ring->records[head & ring->mask];
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    record->timestamp_ns = now.tv_sec * 1000000000ULL + now.tv_nsec;
+    return record;
+}
+
+void RealTimeLog::Commit()
+{
+    Ring *ring = thread_ring;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+} // namespace Realtime
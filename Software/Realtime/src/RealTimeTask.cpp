@@ -22,17 +22,34 @@
  */
 
 #include <Realtime/RealTimeTask.hpp>
+#include <Realtime/RealTimeLog.hpp>
+#include <Systems/TscClock.hpp>
 
 #include <limits.h>
 #include <pthread.h>
 #include <sched.h>
 #include <unistd.h>
 #include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <linux/capability.h>
 
 #include <iostream>
 #include <string>
+#include <cstring>
+#include <cstdlib>
 #include <chrono>
 #include <map>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <sstream>
 
 
 // Timing comparison
@@ -60,6 +77,23 @@
     }                                         \
   } while (0)
 
+// SCHED_DEADLINE is not wrapped by glibc
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+struct sched_attr_t
+{
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
 namespace Realtime
 {
 RealTimeTaskNode::RealTimeTaskNode(const std::string &name,
@@ -71,10 +105,51 @@ RealTimeTaskNode::RealTimeTaskNode(const std::string &name,
                                                                     rt_priority_(rt_priority),
                                                                     rt_core_id_(rt_core_id),
                                                                     stack_size_(stack_size),
+                                                                    use_core_mask_(false),
+                                                                    scheduling_mode_(SchedulingMode::BUSY_WAIT),
+                                                                    spin_tail_(50),
+                                                                    scheduling_policy_(SchedulingPolicy::TIME_SHARING),
+                                                                    active_policy_(SchedulingPolicy::TIME_SHARING),
+                                                                    deadline_runtime_(0),
+                                                                    wcet_(0),
+                                                                    release_offset_(AUTO_OFFSET),
+                                                                    phase_offset_(0),
+                                                                    phased_(false),
+                                                                    trigger_port_id_(-1),
+                                                                    trigger_fd_(-1),
+                                                                    trigger_min_interarrival_(0),
+                                                                    trigger_timeout_(0),
                                                                     thread_status_(-1),
                                                                     process_id_(-1),
-                                                                    thread_cancel_event_(false)
+                                                                    thread_tid_(-1),
+                                                                    minor_faults_base_(0),
+                                                                    major_faults_base_(0),
+                                                                    thread_cancel_event_(false),
+                                                                    started_(false),
+                                                                    executive_(NULL),
+                                                                    overrun_policy_(OverrunPolicy::SKIP_NEXT),
+                                                                    max_catch_up_(1),
+                                                                    catch_up_count_(0),
+                                                                    consecutive_overruns_(0),
+                                                                    watchdog_limit_(0),
+                                                                    watchdog_tripped_(false),
+                                                                    memory_profiling_(false),
+                                                                    stack_low_(0),
+                                                                    stack_high_(0),
+                                                                    stack_high_water_(0),
+                                                                    stack_alive_(false),
+                                                                    resource_accounting_(false),
+                                                                    perf_counting_(false),
+                                                                    parameter_version_(0),
+                                                                    allocation_tracking_(false),
+                                                                    allocation_flags_(AllocationTracker::NONE),
+                                                                    allocations_(0),
+                                                                    frees_(0),
+                                                                    allocated_bytes_(0),
+                                                                    allocating_cycles_(0)
 {
+    heap_usage_.current_bytes = 0;
+    heap_usage_.peak_bytes = 0;
 
     // Add to task manager
     RealTimeTaskManager::Instance()->AddTask(this);
@@ -89,25 +164,36 @@ RealTimeTaskNode::~RealTimeTaskNode()
 void *RealTimeTaskNode::RunTask(void *task_instance)
 {
     RealTimeTaskNode *task = static_cast<RealTimeTaskNode *>(task_instance);
-    std::cout << "[RealTimeTaskNode]: "
-              << "Starting Task: " << task->task_name_ << std::endl;
+
+    // Task thread logs through its own ring.  Allocate it before anything is printed
+    RealTimeLog::RegisterThread();
+    RealTimeLog::Print("[RealTimeTaskNode]: Starting Task: {}", task->task_name_);
 
     task->process_id_ = getpid();
+    task->thread_id_ = pthread_self(); // pthread_create may not have stored it yet
+    task->thread_tid_ = syscall(SYS_gettid);
 
     pthread_attr_t attr;
     size_t stacksize;
     pthread_attr_init(&attr);
     pthread_attr_getstacksize(&attr, &stacksize);
-    std::cout << "STACK SIZE: " << stacksize << " bytes" << std::endl;
+    RealTimeLog::Print("STACK SIZE: {} bytes", stacksize);
 
 
-    // TODO: Do we want to have support for adding to multiple CPUs here?
-    // TODO: Task manager keeps up with which task are pinned to which CPUs.  Could make sure high priority task maybe get pinned to unused cores?
     cpu_set_t cpu_set;
-    if (task->rt_core_id_ >= 0 && task->rt_core_id_ < RealTimeTaskManager::Instance()->GetCPUCount())
+    if (task->use_core_mask_)
     {
-        std::cout << "[RealTimeTaskNode]: "
-                  << "Setting Thread Affinity to CPU CORE: " << task->rt_core_id_ << std::endl;
+        RealTimeLog::Print("[RealTimeTaskNode]: Setting Thread Affinity to CPU CORES: {}", CpuTopology::FormatCPUSet(task->rt_core_mask_));
+
+        const int set_result = pthread_setaffinity_np(task->thread_id_, sizeof(cpu_set_t), &task->rt_core_mask_);
+        if (set_result != 0)
+        {
+            RealTimeLog::Print("[RealTimeTaskNode]: Failed to set thread affinity: {}", set_result);
+        }
+    }
+    else if (task->rt_core_id_ >= 0 && task->rt_core_id_ < RealTimeTaskManager::Instance()->GetCPUCount())
+    {
+        RealTimeLog::Print("[RealTimeTaskNode]: Setting Thread Affinity to CPU CORE: {}", task->rt_core_id_);
 
         // Clear out CPU set type
         CPU_ZERO(&cpu_set);
@@ -119,74 +205,254 @@ void *RealTimeTaskNode::RunTask(void *task_instance)
         const int set_result = pthread_setaffinity_np(task->thread_id_, sizeof(cpu_set_t), &cpu_set);
         if (set_result != 0)
         {
-            std::cout << "[RealTimeTaskNode]: "
-                      << "Failed to set thread affinity: " << set_result << std::endl;
+            RealTimeLog::Print("[RealTimeTaskNode]: Failed to set thread affinity: {}", set_result);
         }
 
         // Verify it was set successfully
         if (CPU_ISSET(task->rt_core_id_, &cpu_set))
         {
-            std::cout << "[RealTimeTaskNode]: "
-                      << "Successfully set thread " << task->thread_id_ << " affinity to CORE: " << task->rt_core_id_ << std::endl;
+            RealTimeLog::Print("[RealTimeTaskNode]: Successfully set thread {} affinity to CORE: {}", task->thread_id_, task->rt_core_id_);
         }
         else
         {
-            std::cout << "[RealTimeTaskNode]: "
-                      << "Failed to set thread " << task->thread_id_ << " affinity to CORE: " << task->rt_core_id_ << std::endl;
+            RealTimeLog::Print("[RealTimeTaskNode]: Failed to set thread {} affinity to CORE: {}", task->thread_id_, task->rt_core_id_);
         }
     }
     else if (task->rt_core_id_ >= RealTimeTaskManager::Instance()->GetCPUCount())
     {
-        std::cout << "[RealTimeTaskNode]: " << task->task_name_
-                  << "\tERROR.  Desired CPU Affinity exceeds number of available cores!" << std::endl
-                  << "Please check system configuration." << std::endl;
+        RealTimeLog::Print("[RealTimeTaskNode]: {}\tERROR.  Desired CPU Affinity exceeds number of available cores!\nPlease check system configuration.", task->task_name_);
     }
 
     // Output what the actually task thread affinity is
     const int set_result = pthread_getaffinity_np(task->thread_id_, sizeof(cpu_set_t), &cpu_set);
     if (set_result != 0)
     {
-        std::cout << "[RealTimeTaskNode]: "
-                  << "Failed to get thread affinity: " << set_result << std::endl;
+        RealTimeLog::Print("[RealTimeTaskNode]: Failed to get thread affinity: {}", set_result);
     }
 
-    std::cout << "[RealTimeTaskNode]: " << task->task_name_ << " running on CPU CORES: \t[";
-    for (int j = 0; j < CPU_SETSIZE; j++)
-    {
-        if (CPU_ISSET(j, &cpu_set))
-        {
-            std::cout << j << "\t";
-        }
-    }
-    std::cout << "]" << std::endl;
+    RealTimeLog::Print("[RealTimeTaskNode]: {} running on CPU CORES: \t[{}]", task->task_name_, CpuTopology::FormatCPUSet(cpu_set));
 
     // Setup thread cancellation.
     // TODO: Look into PTHREAD_CANCEL_DEFERRED
     pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
 
+    // Real time policy.  SCHED_DEADLINE without a runtime is applied after a calibration window
+    if (task->scheduling_policy_ != SchedulingPolicy::DEADLINE || task->deadline_runtime_ > 0)
+    {
+        task->ApplySchedulingPolicy();
+    }
+
+    // Fault in the stack before Setup so the first control cycles do not take page faults
+    if (RealTimeTaskManager::Instance()->IsRealtimeMemoryEnabled())
+    {
+        task->PrefaultStack();
+    }
+
+    // Timer wakeups exactly on the requested time.  Real time policies already ignore the slack
+    if (RealTimeTaskManager::Instance()->IsLowLatencyModeEnabled())
+    {
+        prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+    }
+
+    // Memory profile covers Setup() too.  Painting touches (and so faults in) the whole stack
+    if (task->memory_profiling_)
+    {
+        task->PaintStack();
+        AllocationTracker::BeginHeapProfile(&task->heap_usage_);
+    }
+
+    // Reader slot for parameter snapshots
+    ParameterStore::RegisterThread();
+
     // Call Setup
     task->Setup();
 
-    // TODO:  Check Control deadlines as well.  If run over we can throw exception here
+    // Allocate the trace buffer outside the loop
+    if (DataflowTracer::IsEnabled())
+    {
+        DataflowTracer::RegisterThread(task->task_name_);
+    }
+
+    // Counters follow this thread.  Opened after Setup() so its work is not counted
+    task->OpenPerformanceCounters();
+
+    // Faults from here on are taken in the run loop
+    task->ReadPageFaults(task->minor_faults_base_, task->major_faults_base_);
+
+    // Absolute release time for ABSOLUTE_HYBRID scheduling.  Anchored at the first cycle so period error does not accumulate
+    struct timespec next_release;
+    struct timespec period;
+    task->AlignRelease(next_release);
+
+    // Cycle timing
+    struct timespec run_start;
+    struct timespec run_end;
+    struct timespec run_time;
+    long int lateness_ns = 0;
+
+    // Phased tasks wait for their first slot on the release epoch grid.  Triggered tasks are released by their producers
+    if (task->phased_ && task->scheduling_mode_ != SchedulingMode::DATA_TRIGGERED)
+    {
+        lateness_ns = TaskDelayUntil(next_release, task->scheduling_mode_ == SchedulingMode::ABSOLUTE_HYBRID ? task->spin_tail_ : 0);
+    }
+
     while (1)
     {
         if(task->IsCancelled())
         {
             break;
         }
-        auto start = std::chrono::high_resolution_clock::now();
+
+        // Parameter updates land between cycles
+        task->ApplyParameterChanges();
+
+        const bool track_allocations = task->allocation_tracking_;
+        if (track_allocations)
+        {
+            AllocationTracker::Begin(task->task_name_.c_str(), task->allocation_flags_);
+        }
+
+        // Cycle span.  Received trace contexts propagate to this cycle's sends
+        const bool traced = DataflowTracer::IsEnabled();
+        DataflowTracer::Span span;
+        if (traced)
+        {
+            DataflowTracer::BeginSpan(span);
+        }
+
+        // Thread usage brackets the wall clock so CPU time never exceeds the run time
+        const bool account = task->resource_accounting_;
+        TaskStatistics::Usage usage_start;
+        TaskStatistics::Usage usage_end;
+        if (account)
+        {
+            TaskStatistics::ReadUsage(usage_start);
+        }
+
+        // Counter group read outside the timed window.  One system call each side
+        const bool count = task->perf_counters_.IsOpen();
+        PerfCounters::Sample perf_start;
+        PerfCounters::Sample perf_end;
+        if (count)
+        {
+            task->perf_counters_.Read(perf_start);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &run_start);
+        TaskArena *previous_arena = TaskArena::Begin(task->run_arena_.get());
         task->Run();
-        auto elapsed = std::chrono::high_resolution_clock::now() - start;
-        long long total_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
-        //std::cout << "Run Time: " << total_us << std::endl;
+        TaskArena::End(previous_arena);
+        clock_gettime(CLOCK_MONOTONIC, &run_end);
+
+        if (count && task->perf_counters_.Read(perf_end))
+        {
+            task->perf_counters_.Record(perf_start, perf_end);
+        }
+
+        if (account)
+        {
+            TaskStatistics::ReadUsage(usage_end);
+        }
+
+        if (traced)
+        {
+            DataflowTracer::EndSpan(span, task->task_name_);
+        }
+
+        if (track_allocations)
+        {
+            AllocationTracker::Counters counters = AllocationTracker::End();
+            task->allocations_ += counters.allocations;
+            task->frees_ += counters.frees;
+            task->allocated_bytes_ += counters.bytes;
+            if (counters.allocations > 0)
+            {
+                task->allocating_cycles_++;
+            }
+        }
+
+        tssub(&run_end, &run_start, &run_time);
+        long int run_ns = run_time.tv_sec * 1000000000L + run_time.tv_nsec;
+        if (account)
+        {
+            task->statistics_.Record(run_ns, lateness_ns, run_ns > task->rt_period_ * 1000L, usage_start, usage_end);
+        }
+        else
+        {
+            task->statistics_.Record(run_ns, lateness_ns, run_ns > task->rt_period_ * 1000L);
+        }
+
+        // Calibration window done.  Switch to SCHED_DEADLINE with the measured runtime
+        if (task->scheduling_policy_ == SchedulingPolicy::DEADLINE && task->active_policy_ != SchedulingPolicy::DEADLINE &&
+            task->deadline_runtime_ == 0 && task->statistics_.Cycles() == DEADLINE_CALIBRATION_CYCLES)
+        {
+            if (task->ApplySchedulingPolicy() == 0)
+            {
+                task->AlignRelease(next_release);
+            }
+        }
+
+        // Absolute releases advance one period from the previous release.  SCHED_DEADLINE always uses them
+        const bool absolute = task->active_policy_ == SchedulingPolicy::DEADLINE || task->scheduling_mode_ == SchedulingMode::ABSOLUTE_HYBRID;
+        if (absolute)
+        {
+            period.tv_sec = task->rt_period_ / 1000000;
+            period.tv_nsec = (task->rt_period_ % 1000000) * 1000;
+            tsadd(&next_release, &period, &next_release);
+        }
+
+        // Deadline check.  Absolute releases miss when Run() ends past the next release, the rest when Run() exceeds the period
+        const bool missed = absolute ? !tscmp(&run_end, &next_release, <) : run_ns > task->rt_period_ * 1000L;
+        long int delay = task->rt_period_ - run_ns / 1000;
+        if (missed)
+        {
+            task->HandleOverrun(next_release, run_end, absolute, delay);
+        }
+        else
+        {
+            task->consecutive_overruns_ = 0;
+            task->catch_up_count_ = 0;
+        }
+
+        // SCHED_DEADLINE runtime is a budget.  Spinning would burn it, so always sleep to an absolute release
+        if (task->active_policy_ == SchedulingPolicy::DEADLINE)
+        {
+            lateness_ns = TaskDelayUntil(next_release, 0);
+        }
+        else if (task->scheduling_mode_ == SchedulingMode::ABSOLUTE_HYBRID)
+        {
+            lateness_ns = TaskDelayUntil(next_release, task->spin_tail_);
+        }
+        else if (task->scheduling_mode_ == SchedulingMode::DATA_TRIGGERED)
+        {
+            lateness_ns = task->WaitForTrigger(run_start);
+        }
+        else
+        {
+            // Remainder is how far past the requested delay we returned.  Catch up releases return immediately and are late by the overrun
+            long int remainder = TaskDelay(delay);
+            lateness_ns = remainder > 0 ? remainder * 1000 : 0;
+        }
+    }
+    RealTimeLog::Print("[RealTimeTaskNode]: Ending Task: {}", task->task_name_);
 
-        long int remainder = TaskDelay(task->rt_period_ - total_us);
-        //std::cout << "Period: " << task->rt_period_ << std::endl;
-        //std::cout << "Target: " <<  task->rt_period_ - total_us << " Overrun: " << remainder << " Total: " << task->rt_period_ - total_us + remainder << std::endl;
-        //std::cout << "Total Task Time: " <<  task->rt_period_ - total_us + remainder + total_us << " Frequency: " <<  1.0 / ((task->rt_period_ - total_us + remainder + total_us) * 1e-6) << " HZ" << std::endl;
+    // Final profile while the stack is still mapped.  Printed directly, so write out this thread's log records first
+    if (task->memory_profiling_)
+    {
+        RealTimeLog::Flush();
+        AllocationTracker::EndHeapProfile();
+        size_t used, size;
+        task->GetStackUsage(used, size);
+        {
+            std::unique_lock<std::mutex> lck(task->profile_mutex_);
+            task->stack_high_water_ = used;
+            task->stack_alive_ = false;
+        }
+        task->PrintMemoryProfile();
     }
-    std::cout << "[RealTimeTaskNode]: "
-              << "Ending Task: " << task->task_name_ << std::endl;
+
+    // Counters are bound to this thread
+    task->perf_counters_.Close();
 
     // Stop the task
     pthread_exit(NULL);
@@ -194,12 +460,33 @@ void *RealTimeTaskNode::RunTask(void *task_instance)
 
 int RealTimeTaskNode::Start(void *task_param)
 {
-    struct sched_param param;
     pthread_attr_t attr;
 
+    // Hosted tasks run on their executive's thread
+    if (executive_ != NULL)
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_ << " is hosted on " << executive_->task_name_ << ".  Start the executive instead." << std::endl;
+        return -1;
+    }
+
     // Set Task Thread Paramters
     task_param_ = task_param;
 
+    // Automatic core placement
+    if (rt_core_id_ == AUTO_AFFINITY)
+    {
+        RealTimeTaskManager::Instance()->PlaceTask(this);
+    }
+
+    // Schedulability check against the running tasks
+    if (!RealTimeTaskManager::Instance()->AdmitTask(this))
+    {
+        return -1;
+    }
+
+    // Release offset on the common release epoch
+    RealTimeTaskManager::Instance()->PhaseTask(this);
+
     // Initialize default thread attributes
     thread_status_ = pthread_attr_init(&attr);
     if (thread_status_)
@@ -218,33 +505,8 @@ int RealTimeTaskNode::Start(void *task_param)
         return thread_status_;
     }
 
-    // TODO: Back of RT Priority until PREEMPT Kernel.
-    // Set Scheduler Policy to RT(SCHED_FIFO)
-    // thread_status_ = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
-    // if (thread_status_)
-    // {
-    //     std::cout << "[RealTimeTaskNode]: "
-    //               << "POSIX Thread failed to set schedule policy!" << std::endl;
-    //     return thread_status_;
-    // }
-    // Set Thread Priority
-    // param.sched_priority = rt_priority_;
-    // thread_status_ = pthread_attr_setschedparam(&attr, &param);
-    // if (thread_status_)
-    // {
-    //     std::cout << "[RealTimeTaskNode]: "
-    //               << "POSIX Thread failed to set thread priority!" << std::endl;
-    //     return thread_status_;
-    // }
-
-    // // Use Scheduling Policy from Attributes.
-    // thread_status_ = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-    // if (thread_status_)
-    // {
-    //     std::cout << "[RealTimeTaskNode]: "
-    //               << "POSIX Thread failed to set scheduling policy from attributes!" << std::endl;
-    //     return thread_status_;
-    // }
+    // Scheduling policy and priority are applied from the task thread (ApplySchedulingPolicy) so a missing
+    // CAP_SYS_NICE falls back to SCHED_OTHER instead of failing thread creation.
 
     // Create our pthread.  Pass an instance of 'this' class as a parameter
     thread_status_ = pthread_create(&thread_id_, &attr, &RunTask, this);
@@ -263,173 +525,1482 @@ int RealTimeTaskNode::Start(void *task_param)
                   << "POSIX Thread failed to detach thread!" << std::endl;
         return thread_status_;
     }
+    started_ = true;
+    return thread_status_;
 }
 
-void RealTimeTaskNode::Stop()
-{
-    // TODO: Wait here for full stop?
-    thread_cancel_event_ = true;
-}
-long int RealTimeTaskNode::TaskDelay(long int microseconds)
+int RealTimeTaskNode::ApplySchedulingPolicy()
 {
-    struct timespec now;
-    struct timespec then;
-    struct timespec start;
-    struct timespec sleep;
-    struct timespec remainder;
-    long int nanoseconds = microseconds * 1e3;
-    if ( nanoseconds > 999999999 )
+    active_policy_ = SchedulingPolicy::TIME_SHARING;
+    if (scheduling_policy_ == SchedulingPolicy::TIME_SHARING)
     {
-        return microseconds;
+        return 0;
     }
-    clock_gettime( CLOCK_MONOTONIC_RAW, &start);
-    now = start;
-    sleep.tv_sec = 0;
-    sleep.tv_nsec = nanoseconds;
-    tsadd( &start, &sleep, &then );
-    while ( tscmp( &now, &then, < )  )
+
+    if (!RealTimeTaskManager::Instance()->HasRealtimeCapability())
     {
-        clock_gettime( CLOCK_MONOTONIC_RAW, &now);
+        RealTimeLog::Print("[RealTimeTaskNode]: {}\tMissing CAP_SYS_NICE.  Falling back to SCHED_OTHER.", task_name_);
+        return EPERM;
     }
-    tssub(&now, &start, &remainder);
-    
-    return (remainder.tv_nsec / 1000) - microseconds;
-}
-long int RealTimeTaskNode::TaskSleep(long int microseconds)
-{
-    // TODO: Absolute wait or relative?
-    // For now we use relative.
-    struct timespec delay;
-    struct timespec remainder;
-    struct timespec ats;
 
-    // Setup Delay Timespec
-    delay.tv_sec = 0;
-    delay.tv_nsec = microseconds * 1e3;
-    if (delay.tv_nsec >= 1000000000) // Wrap Overruns
+    if (scheduling_policy_ == SchedulingPolicy::FIFO || scheduling_policy_ == SchedulingPolicy::ROUND_ROBIN)
     {
-        delay.tv_nsec -= 1000000000;
-        delay.tv_sec++;
-    }
+        struct sched_param param;
+        param.sched_priority = ToSchedPriority(rt_priority_);
 
-    // Get the start time of the delay.  To be used to know over and underruns
-    clock_gettime(CLOCK_MONOTONIC_RAW, &ats);
+        const int policy = (scheduling_policy_ == SchedulingPolicy::FIFO) ? SCHED_FIFO : SCHED_RR;
+        const int result = pthread_setschedparam(pthread_self(), policy, &param);
+        if (result != 0)
+        {
+            RealTimeLog::Print("[RealTimeTaskNode]: {}\tFailed to set real time policy: {}.  Falling back to SCHED_OTHER.", task_name_, result);
+            return result;
+        }
 
-    // Add the delay offset to know when this SHOULD end.
-    ats.tv_sec += delay.tv_sec;
-    ats.tv_nsec += delay.tv_nsec;
+        active_policy_ = scheduling_policy_;
+        RealTimeLog::Print("[RealTimeTaskNode]: {}\tRunning {} at priority: {}", task_name_, (policy == SCHED_FIFO) ? "SCHED_FIFO" : "SCHED_RR", param.sched_priority);
+        return 0;
+    }
 
-    // Sleep for delay
-    clock_nanosleep(CLOCK_MONOTONIC_RAW, 0, &delay, &remainder);
+    // SCHED_DEADLINE.  Runtime is the configured runtime or the measured WCET plus margin, bounded by the period
+    uint64_t period_ns = rt_period_ * 1000ULL;
+    uint64_t runtime_ns = deadline_runtime_ * 1000ULL;
+    if (runtime_ns == 0)
+    {
+        TaskStatistics::Snapshot stats;
+        statistics_.GetSnapshot(stats);
+        runtime_ns = stats.execution_max_ns + stats.execution_max_ns / 4;
+    }
+    if (runtime_ns < 1024) // Kernel minimum runtime
+    {
+        runtime_ns = 1024;
+    }
+    if (runtime_ns > period_ns)
+    {
+        runtime_ns = period_ns;
+    }
 
-    // Get the time now after the delay.
-    clock_gettime(CLOCK_MONOTONIC_RAW, &remainder);
+    struct sched_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_runtime = runtime_ns;
+    attr.sched_deadline = period_ns;
+    attr.sched_period = period_ns;
 
-    // Compute difference and calculcate over/underrun
-    remainder.tv_sec -= ats.tv_sec;
-    remainder.tv_nsec -= ats.tv_nsec;
-    if (remainder.tv_nsec < 0) // Wrap nanosecond overruns
+    if (syscall(SYS_sched_setattr, 0, &attr, 0) != 0)
     {
-        remainder.tv_nsec += 1000000000;
-        remainder.tv_sec++;
+        // EBUSY = admission control rejected the bandwidth, EPERM = restricted affinity or no capability
+        const int error = errno;
+        RealTimeLog::Print("[RealTimeTaskNode]: {}\tFailed to set SCHED_DEADLINE: {}.  Falling back to SCHED_OTHER.", task_name_, strerror(error));
+        return error;
     }
-    return remainder.tv_nsec / 1000;
-}
 
-void RealTimeTaskNode::SetTaskFrequency(const unsigned int frequency_hz)
-{
-    // Frequency must be greater than 0
-    assert(frequency_hz > 0);
-
-    // Period in microseconds
-    SetTaskPeriod(long((1.0 / frequency_hz) * 1e6));
+    active_policy_ = SchedulingPolicy::DEADLINE;
+    RealTimeLog::Print("[RealTimeTaskNode]: {}\tRunning SCHED_DEADLINE Runtime: {}us Deadline/Period: {}us", task_name_, runtime_ns / 1000, rt_period_);
+    return 0;
 }
 
-// Get Output Port
-std::shared_ptr<Port> RealTimeTaskNode::GetOutputPort(const int port_id) const
+bool RealTimeTaskNode::SetTriggerPort(const int port_id, const long min_interarrival, const long timeout)
 {
     assert(port_id >= 0 && port_id < MAX_PORTS);
-    return output_port_map_[port_id];
-}
+    if (!input_port_map_[port_id])
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_ << "\tNo input port " << port_id << " to trigger on." << std::endl;
+        return false;
+    }
 
-// Get Input Port
-std::shared_ptr<Port> RealTimeTaskNode::GetInputPort(const int port_id) const
-{
-    assert(port_id >= 0 && port_id < MAX_PORTS);
-    return input_port_map_[port_id];
+    const int fd = input_port_map_[port_id]->EnableTrigger();
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    trigger_port_id_ = port_id;
+    trigger_fd_ = fd;
+    trigger_min_interarrival_ = min_interarrival;
+    trigger_timeout_ = timeout;
+    scheduling_mode_ = SchedulingMode::DATA_TRIGGERED;
+    return true;
 }
 
-void RealTimeTaskNode::SetPortOutput(const int port_id, const Port::TransportType transport, const std::string &transport_url, const std::string &channel)
+long int RealTimeTaskNode::WaitForTrigger(const struct timespec &last_release)
 {
-    assert(port_id >= 0 && port_id < MAX_PORTS);
-    output_port_map_[port_id]->SetTransport(transport, transport_url, channel);
-}
+    // Hold the release for the minimum inter-arrival.  Messages arriving meanwhile stay signalled
+    if (trigger_min_interarrival_ > 0)
+    {
+        struct timespec interarrival;
+        struct timespec earliest;
+        interarrival.tv_sec = trigger_min_interarrival_ / 1000000;
+        interarrival.tv_nsec = (trigger_min_interarrival_ % 1000000) * 1000;
+        tsadd(&last_release, &interarrival, &earliest);
+        TaskDelayUntil(earliest, spin_tail_);
+    }
 
-// Task Manager Source
+    // Wait for arrival.  Timeout falls back to a periodic release
+    const long timeout = (trigger_timeout_ > 0) ? trigger_timeout_ : rt_period_;
+    struct timespec wait;
+    wait.tv_sec = timeout / 1000000;
+    wait.tv_nsec = (timeout % 1000000) * 1000;
 
-// Global static pointer used to ensure a single instance of the class.
-RealTimeTaskManager *RealTimeTaskManager::manager_instance_ = NULL;
+    struct pollfd trigger;
+    trigger.fd = trigger_fd_;
+    trigger.events = POLLIN;
+    trigger.revents = 0;
 
-RealTimeTaskManager::RealTimeTaskManager()
-{
-    // Get CPU Count
-    cpu_count_ = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ppoll(&trigger, 1, &wait, NULL) <= 0)
+    {
+        return 0;
+    }
 
-    std::cout << "[RealTimeTaskManager]: Task manager RUNNING.  Total Number of CPUS available: " << cpu_count_ << std::endl;
+    // Clear the event count
+    uint64_t events;
+    if (read(trigger_fd_, &events, sizeof(events)) < 0)
+    {
+        return 0;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t now_ns = now.tv_sec * 1000000000ULL + now.tv_nsec;
+    const uint64_t arrival_ns = input_port_map_[trigger_port_id_]->GetLastArrival();
+    return (arrival_ns > 0 && now_ns > arrival_ns) ? now_ns - arrival_ns : 0;
 }
 
-RealTimeTaskManager *RealTimeTaskManager::Instance()
+void RealTimeTaskNode::AlignRelease(struct timespec &release) const
 {
-    if (manager_instance_ == NULL)
+    clock_gettime(CLOCK_MONOTONIC, &release);
+    if (!phased_ || rt_period_ <= 0)
+        return;
+
+    const uint64_t now_ns = release.tv_sec * 1000000000ULL + release.tv_nsec;
+    const uint64_t period_ns = rt_period_ * 1000ULL;
+    uint64_t release_ns = RealTimeTaskManager::Instance()->GetReleaseEpoch() + phase_offset_;
+    if (release_ns < now_ns)
     {
-        manager_instance_ = new RealTimeTaskManager();
+        release_ns += ((now_ns - release_ns + period_ns - 1) / period_ns) * period_ns;
     }
-    return manager_instance_;
+
+    release.tv_sec = release_ns / 1000000000ULL;
+    release.tv_nsec = release_ns % 1000000000ULL;
 }
 
-bool RealTimeTaskManager::AddTask(RealTimeTaskNode *task)
+void RealTimeTaskNode::SetOverrunPolicy(const OverrunPolicy policy, const int max_catch_up)
 {
-    assert(task != NULL);
+    overrun_policy_ = policy;
+    max_catch_up_ = max_catch_up;
+}
 
-    for (int i = 0; i < task_map_.size(); i++)
+void RealTimeTaskNode::HandleOverrun(struct timespec &next_release, const struct timespec &now, const bool absolute, long int &delay)
+{
+    consecutive_overruns_++;
+    if (watchdog_limit_ > 0 && consecutive_overruns_ >= watchdog_limit_ && !watchdog_tripped_)
     {
-        if (task_map_[i] == task)
+        watchdog_tripped_ = true;
+        RealTimeLog::Print("[RealTimeTaskNode]: {}\tWATCHDOG.  Missed {} consecutive deadlines!", task_name_, consecutive_overruns_);
+    }
+
+    if (overrun_policy_ == OverrunPolicy::NOTIFY)
+    {
+        OnOverrun();
+    }
+
+    // Relative releases.  A catch up release follows at once, otherwise wait out the rest of the period the overrun ran into
+    if (!absolute)
+    {
+        if (overrun_policy_ == OverrunPolicy::CATCH_UP && catch_up_count_ < max_catch_up_)
         {
-            std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " already exists." << std::endl;
-            return false;
+            catch_up_count_++;
+            delay = 0;
+            return;
+        }
+
+        catch_up_count_ = 0;
+        if (rt_period_ > 0)
+        {
+            const long int run_us = rt_period_ - delay;
+            delay = rt_period_ - run_us % rt_period_;
         }
+        return;
     }
 
-    task_map_.push_back(task);
+    // Release the missed cycles back to back, up to the burst limit
+    if (overrun_policy_ == OverrunPolicy::CATCH_UP && catch_up_count_ < max_catch_up_)
+    {
+        catch_up_count_++;
+        return;
+    }
 
-    std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " successfully added." << std::endl;
-    return true;
+    // Drop the missed releases.  Resync to the first release boundary after now
+    catch_up_count_ = 0;
+    const long long period_ns = rt_period_ * 1000LL;
+    const long long late_ns = (now.tv_sec - next_release.tv_sec) * 1000000000LL + (now.tv_nsec - next_release.tv_nsec);
+    const long long skip_ns = (late_ns / period_ns + 1) * period_ns;
+
+    struct timespec skip;
+    skip.tv_sec = skip_ns / 1000000000LL;
+    skip.tv_nsec = skip_ns % 1000000000LL;
+    tsadd(&next_release, &skip, &next_release);
 }
 
-bool RealTimeTaskManager::EndTask(RealTimeTaskNode *task)
+void RealTimeTaskNode::SetAllocationTracking(const bool enable, const int flags)
 {
-    assert(task != NULL);
+    if (enable && !AllocationTracker::IsAvailable())
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_
+                  << "\tAllocation tracking requested but not built.  Configure with -DREALTIME_ALLOCATION_TRACKER=ON" << std::endl;
+    }
+    allocation_flags_ = flags;
+    allocation_tracking_ = enable;
+}
 
-    for (int i = 0; i < task_map_.size(); i++)
+void RealTimeTaskNode::SetRunArena(const size_t capacity)
+{
+    if (!TaskArena::IsAvailable())
     {
-        if (task_map_[i] == task)
-        {
-            task->Stop();
-            task_map_.erase(task_map_.begin() + i);
-            std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " successfully removed" << std::endl;
-            return true;
-        }
+        std::cout << "[RealTimeTaskNode]: " << task_name_
+                  << "\tRun() arena requested but not built.  Configure with -DREALTIME_ALLOCATION_TRACKER=ON" << std::endl;
+        return;
     }
 
-    std::cout << "[RealTimeTaskManager]: No Task " << task->task_name_ << " currently running" << std::endl;
-    return false;
+    run_arena_.reset(new TaskArena(capacity));
+    if (!run_arena_->IsValid())
+    {
+        run_arena_.reset();
+    }
 }
 
-void RealTimeTaskManager::PrintActiveTasks()
+bool RealTimeTaskNode::GetArenaCounters(TaskArena::Counters &counters) const
 {
-    for (auto task : task_map_)
-    {
-        std::cout << "[RealTimeTaskManager]: Task: " << task->task_name_ << "\tPriority: " << task->rt_priority_ << "\tCPU Affinity: " << task->rt_core_id_ << std::endl;
+    if (!run_arena_)
+        return false;
+
+    run_arena_->GetCounters(counters);
+    return true;
+}
+
+void RealTimeTaskNode::GetAllocationCounters(AllocationTracker::Counters &counters, uint64_t &allocating_cycles) const
+{
+    counters.allocations = allocations_;
+    counters.frees = frees_;
+    counters.bytes = allocated_bytes_;
+    allocating_cycles = allocating_cycles_;
+}
+
+namespace
+{
+// Bounds of the calling thread's stack, guard page excluded
+bool GetThreadStack(uintptr_t &low, size_t &size)
+{
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0)
+        return false;
+
+    void *stack_addr;
+    const int result = pthread_attr_getstack(&attr, &stack_addr, &size);
+    pthread_attr_destroy(&attr);
+    low = (uintptr_t)stack_addr;
+    return result == 0;
+}
+} // namespace
+
+void RealTimeTaskNode::PrefaultStack()
+{
+    uintptr_t stack_low;
+    size_t stack_size;
+    if (!GetThreadStack(stack_low, stack_size))
+        return;
+
+    // Write a byte per page from the bottom of the stack up to a margin below this frame.  Bounded by the real stack,
+    // so glibc's static TLS and the frames in use are never overrun
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const uintptr_t limit = (uintptr_t)__builtin_frame_address(0) - STACK_PAINT_MARGIN;
+    for (uintptr_t page = stack_low; page < limit; page += page_size)
+    {
+        *(volatile unsigned char *)page = 0;
+    }
+}
+
+void RealTimeTaskNode::PaintStack()
+{
+    uintptr_t stack_low;
+    size_t stack_size;
+    if (!GetThreadStack(stack_low, stack_size))
+        return;
+
+    // Paint from the bottom up to a margin below this frame.  Plain loop so nothing is called into the painted range
+    const uintptr_t limit = ((uintptr_t)__builtin_frame_address(0) - STACK_PAINT_MARGIN) & ~(uintptr_t)7;
+    for (volatile uint64_t *word = (volatile uint64_t *)stack_low; (uintptr_t)word < limit; word++)
+    {
+        *word = STACK_PATTERN;
+    }
+
+    std::unique_lock<std::mutex> lck(profile_mutex_);
+    stack_low_ = stack_low;
+    stack_high_ = stack_low_ + stack_size;
+    stack_alive_ = true;
+}
+
+bool RealTimeTaskNode::GetStackUsage(size_t &used, size_t &size) const
+{
+    std::unique_lock<std::mutex> lck(profile_mutex_);
+    if (stack_low_ == 0)
+        return false;
+
+    size = stack_high_ - stack_low_;
+    if (!stack_alive_)
+    {
+        used = stack_high_water_;
+        return true;
+    }
+
+    // Lowest word the stack has grown to.  Read while the task runs, so only ever an underestimate by a word
+    const volatile uint64_t *word = (const volatile uint64_t *)stack_low_;
+    while ((uintptr_t)word < stack_high_ && *word == STACK_PATTERN)
+    {
+        word++;
+    }
+    used = stack_high_ - (uintptr_t)word;
+    return true;
+}
+
+bool RealTimeTaskNode::GetHeapUsage(int64_t &current, int64_t &peak) const
+{
+    if (!memory_profiling_ || !AllocationTracker::IsAvailable())
+        return false;
+
+    current = heap_usage_.current_bytes.load(std::memory_order_relaxed);
+    peak = heap_usage_.peak_bytes.load(std::memory_order_relaxed);
+    return true;
+}
+
+void RealTimeTaskNode::PrintMemoryProfile() const
+{
+    size_t used = 0, size = 0;
+    if (GetStackUsage(used, size))
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_ << "\tStack High Water: " << used << " of " << size << " bytes ("
+                  << (size ? 100 * used / size : 0) << "%)" << std::endl;
+    }
+
+    int64_t current = 0, peak = 0;
+    if (GetHeapUsage(current, peak))
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_ << "\tHeap Peak: " << peak << " bytes Live: " << current << " bytes" << std::endl;
+    }
+    else if (memory_profiling_)
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_ << "\tHeap profile needs the REALTIME_ALLOCATION_TRACKER build option" << std::endl;
+    }
+}
+
+bool RealTimeTaskNode::ReadPageFaults(uint64_t &minor_faults, uint64_t &major_faults) const
+{
+    const pid_t tid = thread_tid_.load();
+    if (tid < 0)
+        return false;
+
+    std::ifstream stat_file("/proc/self/task/" + std::to_string(tid) + "/stat");
+    if (!stat_file.is_open())
+        return false;
+
+    // Skip "pid (comm) ".  comm may contain spaces so split at the last ')'
+    std::string line;
+    std::getline(stat_file, line);
+    size_t comm_end = line.rfind(')');
+    if (comm_end == std::string::npos)
+        return false;
+
+    // Fields after comm start at field 3 (state).  minflt is field 10, majflt is field 12
+    std::istringstream fields(line.substr(comm_end + 2));
+    std::string field;
+    for (int i = 3; i <= 12 && fields >> field; i++)
+    {
+        if (i == 10)
+            minor_faults = std::stoull(field);
+        else if (i == 12)
+            major_faults = std::stoull(field);
+    }
+    return true;
+}
+
+bool RealTimeTaskNode::GetPageFaults(uint64_t &minor_faults, uint64_t &major_faults) const
+{
+    if (!ReadPageFaults(minor_faults, major_faults))
+        return false;
+
+    minor_faults -= minor_faults_base_;
+    major_faults -= major_faults_base_;
+    return true;
+}
+
+int RealTimeTaskNode::ToSchedPriority(const unsigned int priority)
+{
+    const int min_priority = sched_get_priority_min(SCHED_FIFO);
+    const int max_priority = sched_get_priority_max(SCHED_FIFO);
+
+    int sched_priority = 100 - (int)priority;
+    if (sched_priority < min_priority)
+        sched_priority = min_priority;
+    if (sched_priority > max_priority)
+        sched_priority = max_priority;
+
+    return sched_priority;
+}
+
+void RealTimeTaskNode::ApplyParameterChanges()
+{
+    if (parameter_hooks_.empty())
+        return;
+
+    const uint64_t version = ParameterStore::Instance()->GetVersion();
+    if (version == parameter_version_)
+        return;
+    parameter_version_ = version;
+
+    ParameterStore::ReadGuard params;
+    for (ParameterHook &entry : parameter_hooks_)
+    {
+        const uint64_t changed = params.GetChangeVersion(entry.index);
+        if (changed != entry.seen_version)
+        {
+            entry.seen_version = changed;
+            entry.hook();
+        }
+    }
+}
+
+void RealTimeTaskNode::OpenPerformanceCounters()
+{
+    if (!perf_counting_ || perf_counters_.IsOpen())
+        return;
+
+    if (!perf_counters_.Open())
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_ << "\tFailed to open performance counters: " << strerror(errno)
+                  << ".  Check /proc/sys/kernel/perf_event_paranoid.  Counting DISABLED." << std::endl;
+        perf_counting_ = false;
+        return;
+    }
+
+    if (!perf_counters_.HasHardware())
+    {
+        std::cout << "[RealTimeTaskNode]: " << task_name_ << "\tNo hardware performance counters.  Counting software events only." << std::endl;
+    }
+}
+
+bool RealTimeTaskNode::GetPerformanceCounters(PerfCounters::Snapshot &snapshot) const
+{
+    if (!perf_counting_)
+        return false;
+
+    perf_counters_.GetSnapshot(snapshot);
+    return snapshot.samples > 0;
+}
+
+void RealTimeTaskNode::PrintPerformanceCounters() const
+{
+    PerfCounters::Snapshot counters;
+    if (!GetPerformanceCounters(counters))
+        return;
+
+    if (counters.available[PerfCounters::CYCLES])
+    {
+        std::cout << "[RealTimeTaskManager]: \tRun() Cycles Mean: " << counters.Mean(PerfCounters::CYCLES) << " Max: " << counters.max[PerfCounters::CYCLES]
+                  << "\tInstructions Mean: " << counters.Mean(PerfCounters::INSTRUCTIONS) << "\tIPC: " << counters.IPC() << std::endl;
+        std::cout << "[RealTimeTaskManager]: \tCache Misses Mean: " << counters.Mean(PerfCounters::CACHE_MISSES) << " Max: " << counters.max[PerfCounters::CACHE_MISSES]
+                  << " Rate: " << counters.CacheMissRate() * 100.0 << "%\tBranch Misses Mean: " << counters.Mean(PerfCounters::BRANCH_MISSES)
+                  << " Rate: " << counters.BranchMissRate() * 100.0 << "%\tMultiplexed Cycles: " << counters.multiplexed_samples << std::endl;
+    }
+    std::cout << "[RealTimeTaskManager]: \tRun() Task Clock (us) Mean: " << counters.Mean(PerfCounters::TASK_CLOCK) * 1e-3
+              << " Max: " << counters.max[PerfCounters::TASK_CLOCK] * 1e-3
+              << "\tContext Switches: " << counters.totals[PerfCounters::CONTEXT_SWITCHES]
+              << " CPU Migrations: " << counters.totals[PerfCounters::CPU_MIGRATIONS]
+              << " Page Faults: " << counters.totals[PerfCounters::PAGE_FAULTS] << std::endl;
+}
+
+void RealTimeTaskNode::Stop()
+{
+    // TODO: Wait here for full stop?
+    thread_cancel_event_ = true;
+}
+long int RealTimeTaskNode::TaskDelay(long int microseconds)
+{
+    struct timespec now;
+    struct timespec then;
+    struct timespec start;
+    struct timespec sleep;
+    struct timespec remainder;
+    long int nanoseconds = microseconds * 1e3;
+    if ( nanoseconds > 999999999 )
+    {
+        return microseconds;
+    }
+    clock_gettime( CLOCK_MONOTONIC_RAW, &start);
+    now = start;
+    sleep.tv_sec = 0;
+    sleep.tv_nsec = nanoseconds;
+    tsadd( &start, &sleep, &then );
+    while ( tscmp( &now, &then, < )  )
+    {
+        clock_gettime( CLOCK_MONOTONIC_RAW, &now);
+    }
+    tssub(&now, &start, &remainder);
+    
+    return (remainder.tv_nsec / 1000) - microseconds;
+}
+long int RealTimeTaskNode::TaskSleep(long int microseconds)
+{
+    // TODO: Absolute wait or relative?
+    // For now we use relative.
+    struct timespec delay;
+    struct timespec remainder;
+    struct timespec ats;
+
+    // Setup Delay Timespec
+    delay.tv_sec = 0;
+    delay.tv_nsec = microseconds * 1e3;
+    if (delay.tv_nsec >= 1000000000) // Wrap Overruns
+    {
+        delay.tv_nsec -= 1000000000;
+        delay.tv_sec++;
+    }
+
+    // Get the start time of the delay.  To be used to know over and underruns
+    clock_gettime(CLOCK_MONOTONIC, &ats);
+
+    // Sleep for delay.  clock_nanosleep() does not accept CLOCK_MONOTONIC_RAW
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &delay, &remainder) == EINTR)
+    {
+        delay = remainder;
+    }
+
+    // Get the time now after the delay.
+    clock_gettime(CLOCK_MONOTONIC, &remainder);
+
+    // Elapsed time of the delay (microseconds)
+    tssub(&remainder, &ats, &remainder);
+    return remainder.tv_sec * 1000000L + remainder.tv_nsec / 1000;
+}
+
+long int RealTimeTaskNode::TaskDelayUntil(const struct timespec &deadline, long int spin_tail)
+{
+    struct timespec now;
+    struct timespec wake;
+    struct timespec tail;
+    struct timespec late;
+
+    // Wake up spin_tail early to absorb timer slack and wake up latency
+    tail.tv_sec = spin_tail / 1000000;
+    tail.tv_nsec = (spin_tail % 1000000) * 1000;
+    tssub(&deadline, &tail, &wake);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (tscmp(&now, &wake, <))
+    {
+        // Sleep to the absolute wake time.  Restart on signal interruption
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR)
+        {
+        }
+    }
+
+    // Spin the remaining tail
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    while (tscmp(&now, &deadline, <))
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+
+    // Release lateness
+    tssub(&now, &deadline, &late);
+    return late.tv_sec * 1000000000L + late.tv_nsec;
+}
+
+void RealTimeTaskNode::SetTaskFrequency(const unsigned int frequency_hz)
+{
+    // Frequency must be greater than 0
+    assert(frequency_hz > 0);
+
+    // Period in microseconds
+    SetTaskPeriod(long((1.0 / frequency_hz) * 1e6));
+}
+
+// Get Output Port
+std::shared_ptr<Port> RealTimeTaskNode::GetOutputPort(const int port_id) const
+{
+    assert(port_id >= 0 && port_id < MAX_PORTS);
+    return output_port_map_[port_id];
+}
+
+// Get Input Port
+std::shared_ptr<Port> RealTimeTaskNode::GetInputPort(const int port_id) const
+{
+    assert(port_id >= 0 && port_id < MAX_PORTS);
+    return input_port_map_[port_id];
+}
+
+void RealTimeTaskNode::SetPortOutput(const int port_id, const Port::TransportType transport, const std::string &transport_url, const std::string &channel)
+{
+    assert(port_id >= 0 && port_id < MAX_PORTS);
+    output_port_map_[port_id]->SetTransport(transport, transport_url, channel);
+}
+
+// Task Manager Source
+
+// Global static pointer used to ensure a single instance of the class.
+RealTimeTaskManager *RealTimeTaskManager::manager_instance_ = NULL;
+
+RealTimeTaskManager::RealTimeTaskManager() : rt_memory_enabled_(false),
+                                             dma_latency_fd_(-1),
+                                             dma_latency_target_(0),
+                                             admission_policy_(AdmissionPolicy::ADMIT_WARN),
+                                             release_phasing_(false),
+                                             release_epoch_ns_(0),
+                                             isolation_priority_(Priority::HIGH)
+{
+    // Get CPU Count
+    cpu_count_ = sysconf(_SC_NPROCESSORS_ONLN);
+
+    std::cout << "[RealTimeTaskManager]: Task manager RUNNING.  Total Number of CPUS available: " << cpu_count_ << std::endl;
+
+    // Check for real time scheduling permission.  CAP_SYS_NICE in the effective set, or an RLIMIT_RTPRIO allowance
+    struct __user_cap_header_struct cap_header;
+    struct __user_cap_data_struct cap_data[2];
+    cap_header.version = _LINUX_CAPABILITY_VERSION_3;
+    cap_header.pid = 0;
+
+    bool has_cap_sys_nice = false;
+    if (syscall(SYS_capget, &cap_header, cap_data) == 0)
+    {
+        has_cap_sys_nice = (cap_data[CAP_SYS_NICE / 32].effective & (1U << (CAP_SYS_NICE % 32))) != 0;
+    }
+
+    struct rlimit rt_limit;
+    bool has_rtprio_limit = (getrlimit(RLIMIT_RTPRIO, &rt_limit) == 0 && rt_limit.rlim_cur > 0);
+
+    // CPU Topology for task placement
+    topology_.Load();
+    topology_.Print();
+
+    // Log drain thread.  Started here from the main thread so it does not inherit a task's policy or affinity
+    RealTimeLog::Start();
+
+    rt_capable_ = has_cap_sys_nice || has_rtprio_limit;
+    if (!rt_capable_)
+    {
+        std::cout << "[RealTimeTaskManager]: CAP_SYS_NICE not available.  Real time scheduling policies will fall back to SCHED_OTHER." << std::endl;
+    }
+}
+
+RealTimeTaskManager *RealTimeTaskManager::Instance()
+{
+    if (manager_instance_ == NULL)
+    {
+        manager_instance_ = new RealTimeTaskManager();
+    }
+    return manager_instance_;
+}
+
+bool RealTimeTaskManager::EnableRealtimeMemory(const size_t heap_reserve)
+{
+    // Never give heap back to the OS and never service allocations with mmap.  Both would fault on reuse
+    if (!mallopt(M_TRIM_THRESHOLD, -1) || !mallopt(M_MMAP_MAX, 0))
+    {
+        std::cout << "[RealTimeTaskManager]: Failed to configure malloc for real time memory." << std::endl;
+        return false;
+    }
+
+    // Single arena.  Task threads would otherwise create (and fault in) their own arenas on first allocation
+    mallopt(M_ARENA_MAX, 1);
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1)
+    {
+        std::cout << "[RealTimeTaskManager]: mlockall failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Pre-touch the heap reserve.  With trimming disabled it stays resident in the arena after the free
+    unsigned char *reserve = static_cast<unsigned char *>(malloc(heap_reserve));
+    if (reserve == NULL)
+    {
+        std::cout << "[RealTimeTaskManager]: Failed to reserve " << heap_reserve << " bytes of heap." << std::endl;
+        return false;
+    }
+
+    const long page_size = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < heap_reserve; i += page_size)
+    {
+        reserve[i] = 0;
+    }
+    free(reserve);
+
+    rt_memory_enabled_ = true;
+    std::cout << "[RealTimeTaskManager]: Real time memory ENABLED.  Heap reserve: " << heap_reserve << " bytes" << std::endl;
+    return true;
+}
+
+static void RestorePowerStateAtExit()
+{
+    RealTimeTaskManager::Instance()->DisableLowLatencyMode();
+}
+
+bool RealTimeTaskManager::EnableLowLatencyMode(const int latency_us)
+{
+    if (dma_latency_fd_ >= 0)
+    {
+        close(dma_latency_fd_);
+        dma_latency_fd_ = -1;
+    }
+
+    dma_latency_fd_ = CpuPower::OpenLatencyRequest(latency_us);
+    if (dma_latency_fd_ < 0)
+    {
+        std::cout << "[RealTimeTaskManager]: Failed to open /dev/cpu_dma_latency: " << strerror(errno) << ".  Low latency mode DISABLED." << std::endl;
+        return false;
+    }
+
+    dma_latency_target_ = latency_us;
+    std::cout << "[RealTimeTaskManager]: Low latency mode ENABLED.  CPU wakeup latency target: " << latency_us << "us" << std::endl;
+    CheckPowerState();
+    return true;
+}
+
+void RealTimeTaskManager::DisableLowLatencyMode()
+{
+    if (dma_latency_fd_ >= 0)
+    {
+        close(dma_latency_fd_);
+        dma_latency_fd_ = -1;
+        std::cout << "[RealTimeTaskManager]: Low latency mode DISABLED." << std::endl;
+    }
+
+    for (const auto &state : restricted_idle_states_)
+    {
+        CpuPower::SetIdleStateDisabled(state.first, state.second, false);
+    }
+    restricted_idle_states_.clear();
+}
+
+bool RealTimeTaskManager::RestrictIdleStates(const int cpu, const int max_latency_us)
+{
+    static bool registered = false;
+    if (!registered)
+    {
+        atexit(RestorePowerStateAtExit);
+        registered = true;
+    }
+
+    bool result = true;
+    for (const CpuPower::IdleState &state : CpuPower::GetIdleStates(cpu))
+    {
+        if (state.latency_us <= max_latency_us || state.disabled)
+            continue;
+
+        if (CpuPower::SetIdleStateDisabled(cpu, state.index, true))
+        {
+            restricted_idle_states_.push_back(std::make_pair(cpu, state.index));
+            std::cout << "[RealTimeTaskManager]: CPU " << cpu << " idle state " << state.name << " (" << state.latency_us << "us) DISABLED" << std::endl;
+        }
+        else
+        {
+            std::cout << "[RealTimeTaskManager]: CPU " << cpu << " failed to disable idle state " << state.name << std::endl;
+            result = false;
+        }
+    }
+    return result;
+}
+
+void RealTimeTaskManager::CheckPowerState()
+{
+    // Cores real time tasks may run on.  Unpinned tasks may run anywhere
+    cpu_set_t rt_cpus;
+    CPU_ZERO(&rt_cpus);
+    for (auto task : task_map_)
+    {
+        if (task->executive_ != NULL || task->scheduling_policy_ == SchedulingPolicy::TIME_SHARING)
+            continue;
+
+        if (task->use_core_mask_)
+        {
+            CPU_OR(&rt_cpus, &rt_cpus, &task->rt_core_mask_);
+        }
+        else if (task->rt_core_id_ >= 0)
+        {
+            CPU_SET(task->rt_core_id_, &rt_cpus);
+        }
+        else
+        {
+            for (const CpuTopology::CPUInfo &info : topology_.GetCPUs())
+                CPU_SET(info.cpu, &rt_cpus);
+        }
+    }
+
+    // No real time tasks yet.  Check everything
+    if (CPU_COUNT(&rt_cpus) == 0)
+    {
+        for (const CpuTopology::CPUInfo &info : topology_.GetCPUs())
+            CPU_SET(info.cpu, &rt_cpus);
+    }
+
+    for (const CpuTopology::CPUInfo &info : topology_.GetCPUs())
+    {
+        if (!CPU_ISSET(info.cpu, &rt_cpus))
+            continue;
+
+        const std::string governor = CpuPower::GetGovernor(info.cpu);
+        std::cout << "[RealTimeTaskManager]: CPU " << info.cpu << "\tGovernor: " << (governor.empty() ? "None" : governor);
+        if (!governor.empty() && governor != "performance")
+        {
+            std::cout << " (WARNING: Frequency changes add latency.  Use \"performance\")";
+        }
+        std::cout << std::endl;
+
+        // States the PM QoS request does not already rule out
+        std::string deep_states;
+        const std::vector<CpuPower::IdleState> states = CpuPower::GetIdleStates(info.cpu);
+        std::cout << "[RealTimeTaskManager]: \tIdle States:" << (states.empty() ? " None" : "");
+        for (const CpuPower::IdleState &state : states)
+        {
+            std::cout << " " << state.name << "(" << state.latency_us << "us" << (state.disabled ? ", Disabled" : "") << ")";
+            if (!state.disabled && dma_latency_fd_ < 0 && state.latency_us > 10)
+            {
+                deep_states += " " + state.name;
+            }
+        }
+        std::cout << std::endl;
+
+        if (!deep_states.empty())
+        {
+            std::cout << "[RealTimeTaskManager]: \tWARNING: Deep idle states enabled:" << deep_states
+                      << ".  Use EnableLowLatencyMode() or RestrictIdleStates()" << std::endl;
+        }
+    }
+}
+
+bool RealTimeTaskManager::AddTask(RealTimeTaskNode *task)
+{
+    assert(task != NULL);
+
+    for (int i = 0; i < task_map_.size(); i++)
+    {
+        if (task_map_[i] == task)
+        {
+            std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " already exists." << std::endl;
+            return false;
+        }
+    }
+
+    task_map_.push_back(task);
+
+    std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " successfully added." << std::endl;
+    return true;
+}
+
+bool RealTimeTaskManager::EndTask(RealTimeTaskNode *task)
+{
+    assert(task != NULL);
+
+    // Placement is kept for tasks started without AddTask() too.  Free a reserved core for the housekeeping tasks
+    housekeeping_tasks_.erase(task);
+    if (reserved_cores_.erase(task))
+    {
+        UpdateHousekeepingTasks();
+    }
+
+    for (int i = 0; i < task_map_.size(); i++)
+    {
+        if (task_map_[i] == task)
+        {
+            task->Stop();
+            release_slots_.erase(task);
+            task_map_.erase(task_map_.begin() + i);
+            std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " successfully removed" << std::endl;
+            return true;
+        }
+    }
+
+    std::cout << "[RealTimeTaskManager]: No Task " << task->task_name_ << " currently running" << std::endl;
+    return false;
+}
+
+bool RealTimeTaskManager::PlaceTask(RealTimeTaskNode *task)
+{
+    assert(task != NULL);
+
+    // Drop any previous placement of this task
+    housekeeping_tasks_.erase(task);
+    if (reserved_cores_.erase(task))
+    {
+        UpdateHousekeepingTasks();
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+
+    if (task->rt_priority_ <= isolation_priority_)
+    {
+        const int core = FindFreePhysicalCore();
+        if (core >= 0)
+        {
+            reserved_cores_[task] = core;
+            CPU_SET(core, &cpu_set);
+            task->SetCoreAffinityMask(cpu_set);
+
+            std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " placed on exclusive CORE: " << core << std::endl;
+
+            // Lower priority tasks started earlier may still be running on the reserved core
+            UpdateHousekeepingTasks();
+            return true;
+        }
+        std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " no free exclusive core.  Placing on housekeeping cores." << std::endl;
+    }
+
+    GetHousekeepingSet(cpu_set);
+
+    // Everything is reserved.  Let the scheduler decide
+    if (CPU_COUNT(&cpu_set) == 0)
+    {
+        task->SetCoreAffinity(RealTimeTaskNode::AUTO_AFFINITY);
+        std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " no housekeeping cores available.  No affinity set." << std::endl;
+        return false;
+    }
+
+    housekeeping_tasks_.insert(task);
+    task->SetCoreAffinityMask(cpu_set);
+    std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " placed on housekeeping CORES: " << CpuTopology::FormatCPUSet(cpu_set) << std::endl;
+    return true;
+}
+
+void RealTimeTaskManager::GetHousekeepingSet(cpu_set_t &cpu_set) const
+{
+    topology_.GetHousekeepingSet(cpu_set);
+    for (const CpuTopology::CPUInfo &info : topology_.GetCPUs())
+    {
+        for (const auto &reservation : reserved_cores_)
+        {
+            if (reservation.second == topology_.GetPhysicalCore(info.cpu))
+            {
+                CPU_CLR(info.cpu, &cpu_set);
+            }
+        }
+    }
+}
+
+void RealTimeTaskManager::UpdateHousekeepingTasks()
+{
+    cpu_set_t cpu_set;
+    GetHousekeepingSet(cpu_set);
+    if (CPU_COUNT(&cpu_set) == 0)
+        return;
+
+    for (RealTimeTaskNode *task : housekeeping_tasks_)
+    {
+        if (CPU_EQUAL(&cpu_set, &task->rt_core_mask_))
+            continue;
+
+        task->SetCoreAffinityMask(cpu_set);
+
+        // Running tasks are moved by thread ID.  A task that has not reached its thread yet picks up the new mask itself
+        const pid_t tid = task->thread_tid_.load();
+        if (task->started_ && tid > 0 && sched_setaffinity(tid, sizeof(cpu_set_t), &cpu_set) != 0)
+        {
+            std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " failed to move to housekeeping CORES: " << strerror(errno) << std::endl;
+            continue;
+        }
+        std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " moved to housekeeping CORES: " << CpuTopology::FormatCPUSet(cpu_set) << std::endl;
+    }
+}
+
+int RealTimeTaskManager::FindFreePhysicalCore() const
+{
+    // With isolcpus only isolated cores are candidates.  Without, any core other than the one handling CPU 0
+    const bool use_isolated = topology_.HasIsolatedCPUs();
+    const int boot_core = topology_.GetPhysicalCore(0);
+
+    // Prefer nohz_full cores on the first pass
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (const CpuTopology::CPUInfo &info : topology_.GetCPUs())
+        {
+            const int core = topology_.GetPhysicalCore(info.cpu);
+            if (core != info.cpu) // Visit each physical core once
+                continue;
+
+            if (pass == 0 && !info.nohz_full)
+                continue;
+
+            if (use_isolated ? !info.isolated : core == boot_core)
+                continue;
+
+            bool reserved = false;
+            for (const auto &reservation : reserved_cores_)
+            {
+                reserved |= (reservation.second == core);
+            }
+
+            // All SMT siblings must be candidates too, they are left idle
+            bool siblings_ok = true;
+            for (int sibling : info.siblings)
+            {
+                const CpuTopology::CPUInfo *sibling_info = topology_.GetCPU(sibling);
+                siblings_ok &= (sibling_info != NULL && (!use_isolated || sibling_info->isolated));
+            }
+
+            if (!reserved && siblings_ok)
+                return core;
+        }
+    }
+    return -1;
+}
+
+SchedulabilityAnalyzer::TaskModel RealTimeTaskManager::BuildTaskModel(const RealTimeTaskNode *task) const
+{
+    SchedulabilityAnalyzer::TaskModel model;
+    model.name = task->task_name_;
+    model.period_ns = task->rt_period_ * 1000ULL;
+
+    // Requested policy.  A task that fell back to SCHED_OTHER is still analyzed as configured
+    model.sched_priority = 0;
+    if (task->scheduling_policy_ == SchedulingPolicy::FIFO || task->scheduling_policy_ == SchedulingPolicy::ROUND_ROBIN)
+    {
+        model.scheduling_class = SchedulabilityAnalyzer::FIXED_PRIORITY;
+        model.sched_priority = RealTimeTaskNode::ToSchedPriority(task->rt_priority_);
+    }
+    else if (task->scheduling_policy_ == SchedulingPolicy::DEADLINE)
+    {
+        model.scheduling_class = SchedulabilityAnalyzer::EARLIEST_DEADLINE;
+    }
+    else
+    {
+        model.scheduling_class = SchedulabilityAnalyzer::BEST_EFFORT;
+    }
+
+    // Single core only.  A mask with one CPU counts as pinned
+    model.core = -1;
+    if (task->use_core_mask_ && CPU_COUNT(&task->rt_core_mask_) == 1)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &task->rt_core_mask_))
+            {
+                model.core = cpu;
+                break;
+            }
+        }
+    }
+    else if (!task->use_core_mask_ && task->rt_core_id_ >= 0)
+    {
+        model.core = task->rt_core_id_;
+    }
+
+    // SCHED_DEADLINE without a configured runtime reserves the measured WCET plus 25% (ApplySchedulingPolicy)
+    const bool deadline_margin = (task->scheduling_policy_ == SchedulingPolicy::DEADLINE);
+
+    TaskStatistics::Snapshot stats;
+    task->GetStatistics(stats);
+    const auto calibrated = calibrated_wcet_.find(task->task_name_);
+
+    if (task->wcet_ > 0)
+    {
+        model.wcet_ns = task->wcet_ * 1000ULL;
+        model.wcet_source = "Configured";
+    }
+    else if (deadline_margin && task->deadline_runtime_ > 0)
+    {
+        model.wcet_ns = task->deadline_runtime_ * 1000ULL;
+        model.wcet_source = "Deadline Runtime";
+    }
+    else if (calibrated != calibrated_wcet_.end())
+    {
+        model.wcet_ns = calibrated->second + (deadline_margin ? calibrated->second / 4 : 0);
+        model.wcet_source = "Calibrated";
+    }
+    else if (stats.cycles > 0)
+    {
+        model.wcet_ns = stats.execution_max_ns + (deadline_margin ? stats.execution_max_ns / 4 : 0);
+        model.wcet_source = "Measured";
+    }
+    else
+    {
+        model.wcet_ns = 0;
+        model.wcet_source = "Unknown";
+    }
+    return model;
+}
+
+bool RealTimeTaskManager::AnalyzeSchedulability(const bool print)
+{
+    SchedulabilityAnalyzer analyzer;
+    analyzer.SetCPUCount(cpu_count_);
+    analyzer.SetDeadlineBandwidth(SchedulabilityAnalyzer::ReadDeadlineBandwidth());
+
+    for (auto task : task_map_)
+    {
+        if (task->executive_ == NULL)
+        {
+            analyzer.AddTask(BuildTaskModel(task));
+        }
+    }
+
+    const bool feasible = analyzer.Analyze();
+    if (print)
+    {
+        analyzer.Print();
+        std::cout << "[RealTimeTaskManager]: Task set is " << (feasible ? "SCHEDULABLE" : "NOT SCHEDULABLE") << std::endl;
+    }
+    return feasible;
+}
+
+bool RealTimeTaskManager::AdmitTask(RealTimeTaskNode *task)
+{
+    assert(task != NULL);
+
+    if (admission_policy_ == AdmissionPolicy::ADMIT_ALL)
+        return true;
+
+    SchedulabilityAnalyzer analyzer;
+    analyzer.SetCPUCount(cpu_count_);
+    analyzer.SetDeadlineBandwidth(SchedulabilityAnalyzer::ReadDeadlineBandwidth());
+
+    const SchedulabilityAnalyzer::TaskModel model = BuildTaskModel(task);
+    analyzer.AddTask(model);
+    for (auto other : task_map_)
+    {
+        if (other != task && other->executive_ == NULL && other->started_ && !other->IsCancelled())
+        {
+            analyzer.AddTask(BuildTaskModel(other));
+        }
+    }
+
+    if (analyzer.Analyze())
+    {
+        if (model.wcet_ns == 0)
+        {
+            std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " has no WCET.  Admitted without analysis." << std::endl;
+        }
+        return true;
+    }
+
+    analyzer.Print();
+    if (admission_policy_ == AdmissionPolicy::ADMIT_FEASIBLE)
+    {
+        reserved_cores_.erase(task);
+        std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " REJECTED.  Task set would not be schedulable." << std::endl;
+        return false;
+    }
+
+    std::cout << "[RealTimeTaskManager]: WARNING: Task set with " << task->task_name_ << " is not schedulable." << std::endl;
+    return true;
+}
+
+void RealTimeTaskManager::ResetReleaseEpoch()
+{
+    // CLOCK_MONOTONIC time of the shared epoch, so every process phased on it releases on the same grid.  The time base
+    // is calibrated against (or falls back on) CLOCK_MONOTONIC, so only a change in the NTP slew rate after the
+    // calibration drifts the grid
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t since_epoch_ns = Systems::TscClock::Instance()->NowNanoseconds();
+    const uint64_t now_ns = now.tv_sec * 1000000000ULL + now.tv_nsec;
+    release_epoch_ns_ = now_ns > since_epoch_ns ? now_ns - since_epoch_ns : 1;
+}
+
+uint64_t RealTimeTaskManager::GetReleaseEpoch()
+{
+    if (release_epoch_ns_ == 0)
+    {
+        ResetReleaseEpoch();
+    }
+    return release_epoch_ns_;
+}
+
+namespace
+{
+// CPUs a task may run on
+void TaskCpus(const bool use_mask, const cpu_set_t &mask, const int core_id, const int cpu_count, cpu_set_t &cpus)
+{
+    CPU_ZERO(&cpus);
+    if (use_mask)
+    {
+        cpus = mask;
+    }
+    else if (core_id >= 0)
+    {
+        CPU_SET(core_id, &cpus);
+    }
+    else
+    {
+        for (int cpu = 0; cpu < cpu_count; cpu++)
+            CPU_SET(cpu, &cpus);
+    }
+}
+} // namespace
+
+bool RealTimeTaskManager::Feeds(const RealTimeTaskNode *producer, const RealTimeTaskNode *consumer) const
+{
+    if (producer == consumer)
+        return false;
+
+    for (int in = 0; in < RealTimeTaskNode::MAX_PORTS; in++)
+    {
+        if (!consumer->input_port_map_[in] || consumer->input_port_map_[in]->GetChannel().empty())
+            continue;
+
+        for (int out = 0; out < RealTimeTaskNode::MAX_PORTS; out++)
+        {
+            if (producer->output_port_map_[out] && producer->output_port_map_[out]->GetChannel() == consumer->input_port_map_[in]->GetChannel())
+                return true;
+        }
+    }
+    return false;
+}
+
+void RealTimeTaskManager::PlaceRelease(RealTimeTaskNode *task)
+{
+    ReleaseSlot slot;
+    slot.wcet_ns = BuildTaskModel(task).wcet_ns;
+    TaskCpus(task->use_core_mask_, task->rt_core_mask_, task->rt_core_id_, cpu_count_, slot.cpus);
+
+    const uint64_t period_ns = task->rt_period_ * 1000ULL;
+    uint64_t offset = 0;
+    if (task->release_offset_ >= 0)
+    {
+        offset = task->release_offset_ * 1000ULL;
+    }
+    else
+    {
+        // Released once its slowest running producer has finished.  A source started after its consumers is placed
+        // to finish before the earliest of them instead
+        bool has_producer = false;
+        uint64_t before_consumers = UINT64_MAX;
+        for (const auto &placed : release_slots_)
+        {
+            if (Feeds(placed.first, task))
+            {
+                offset = std::max(offset, placed.second.offset_ns + placed.second.wcet_ns);
+                has_producer = true;
+            }
+            else if (period_ns > 0 && Feeds(task, placed.first))
+            {
+                const uint64_t wcet = slot.wcet_ns % period_ns;
+                before_consumers = std::min(before_consumers, (placed.second.offset_ns % period_ns + period_ns - wcet) % period_ns);
+            }
+        }
+        if (!has_producer && before_consumers != UINT64_MAX)
+            offset = before_consumers;
+    }
+
+    // Stagger a timer released task whose release window [offset, offset + WCET) collides with a running task on a
+    // shared CPU.  Windows repeat every gcd of the two periods.  Running tasks keep their slot
+    const bool movable = task->release_offset_ < 0 && task->scheduling_mode_ != SchedulingMode::DATA_TRIGGERED &&
+                         slot.wcet_ns > 0 && period_ns > 0;
+    for (int attempt = 0; movable && attempt <= (int)release_slots_.size(); attempt++)
+    {
+        bool moved = false;
+        for (const auto &placed : release_slots_)
+        {
+            const ReleaseSlot &other = placed.second;
+            cpu_set_t shared;
+            CPU_AND(&shared, &slot.cpus, &other.cpus);
+            const uint64_t gcd = std::gcd(period_ns, (uint64_t)placed.first->rt_period_ * 1000ULL);
+            if (other.wcet_ns == 0 || CPU_COUNT(&shared) == 0 || gcd == 0 || slot.wcet_ns + other.wcet_ns > gcd)
+                continue;
+
+            const uint64_t start = offset % gcd;
+            const uint64_t other_start = other.offset_ns % gcd;
+            const bool overlap = (other_start + gcd - start) % gcd < slot.wcet_ns || (start + gcd - other_start) % gcd < other.wcet_ns;
+            if (overlap)
+            {
+                offset += (other_start + other.wcet_ns + gcd - start) % gcd;
+                moved = true;
+            }
+        }
+        if (!moved)
+            break;
+    }
+
+    slot.offset_ns = period_ns > 0 ? offset % period_ns : 0;
+    release_slots_[task] = slot;
+
+    // Task thread not started yet
+    task->phase_offset_ = slot.offset_ns;
+    task->phased_ = true;
+}
+
+void RealTimeTaskManager::PhaseTask(RealTimeTaskNode *task)
+{
+    assert(task != NULL);
+
+    // Restarted task.  Placed again against the others
+    release_slots_.erase(task);
+
+    if (release_phasing_)
+    {
+        PlaceRelease(task);
+    }
+    else
+    {
+        task->phased_ = task->release_offset_ >= 0;
+        task->phase_offset_ = task->phased_ ? task->release_offset_ * 1000ULL : 0;
+    }
+
+    if (task->phased_)
+    {
+        std::cout << "[RealTimeTaskManager]: Task " << task->task_name_ << " released at offset " << task->phase_offset_ / 1000 << "us from the release epoch." << std::endl;
+    }
+}
+
+void RealTimeTaskManager::PrintReleaseOffsets() const
+{
+    for (const auto &placed : release_slots_)
+    {
+        std::cout << "[RealTimeTaskManager]: Task " << placed.first->task_name_ << "\tRelease Offset: " << placed.second.offset_ns / 1000 << "us"
+                  << "\tWCET: " << placed.second.wcet_ns / 1000 << "us\tProducers:";
+        for (const auto &other : release_slots_)
+        {
+            if (Feeds(other.first, placed.first))
+                std::cout << " " << other.first->task_name_;
+        }
+        std::cout << std::endl;
+    }
+}
+
+bool RealTimeTaskManager::SaveWcetCalibration(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "[RealTimeTaskManager]: Failed to open WCET calibration file: " << path << std::endl;
+        return false;
+    }
+
+    file << "# Nomad WCET calibration.  Task name, maximum Run() time (ns)" << std::endl;
+
+    TaskStatistics::Snapshot stats;
+    int saved = 0;
+    for (auto task : task_map_)
+    {
+        task->GetStatistics(stats);
+        if (stats.cycles == 0)
+            continue;
+
+        file << task->task_name_ << " " << stats.execution_max_ns << std::endl;
+        saved++;
+    }
+
+    std::cout << "[RealTimeTaskManager]: Saved WCET calibration for " << saved << " tasks to " << path << std::endl;
+    return true;
+}
+
+bool RealTimeTaskManager::LoadWcetCalibration(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "[RealTimeTaskManager]: No WCET calibration file: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int loaded = 0;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        // Task names may contain spaces.  The WCET is the last field
+        const size_t split = line.find_last_of(' ');
+        if (split == std::string::npos || split == 0)
+            continue;
+
+        calibrated_wcet_[line.substr(0, split)] = std::strtoull(line.c_str() + split + 1, NULL, 10);
+        loaded++;
+    }
+
+    std::cout << "[RealTimeTaskManager]: Loaded WCET calibration for " << loaded << " tasks from " << path << std::endl;
+    return true;
+}
+
+void RealTimeTaskManager::PrintActiveTasks()
+{
+    TaskStatistics::Snapshot stats;
+    for (auto task : task_map_)
+    {
+        std::cout << "[RealTimeTaskManager]: Task: " << task->task_name_ << "\tPriority: " << task->rt_priority_ << "\tCPU Affinity: "
+                  << (task->use_core_mask_ ? CpuTopology::FormatCPUSet(task->rt_core_mask_) : std::to_string(task->rt_core_id_))
+                  << "\tPolicy: " << task->active_policy_.load() << std::endl;
+
+        task->GetStatistics(stats);
+        if (stats.cycles == 0)
+            continue;
+
+        uint64_t minor_faults = 0;
+        uint64_t major_faults = 0;
+        task->GetPageFaults(minor_faults, major_faults);
+
+        if (task->IsWatchdogTripped())
+        {
+            std::cout << "[RealTimeTaskManager]: \tWATCHDOG TRIPPED.  Consecutive missed deadlines exceeded " << task->watchdog_limit_ << std::endl;
+        }
+
+        std::cout << "[RealTimeTaskManager]: \tPage Faults Minor: " << minor_faults << " Major: " << major_faults << std::endl;
+
+        if (task->memory_profiling_)
+        {
+            task->PrintMemoryProfile();
+        }
+
+        // Input queue lock contention.  Waits here are priority inversion candidates
+        for (int i = 0; i < RealTimeTaskNode::MAX_PORTS; i++)
+        {
+            PortMutex::Counters counters;
+            if (!task->input_port_map_[i] || !task->input_port_map_[i]->GetLockCounters(counters) || counters.contentions == 0)
+                continue;
+
+            std::cout << "[RealTimeTaskManager]: \tPort: " << task->input_port_map_[i]->GetName() << " Lock Contentions: " << counters.contentions
+                      << "/" << counters.acquisitions << " Wait (us) Mean: " << (counters.wait_total_ns / counters.contentions) * 1e-3
+                      << " Max: " << counters.wait_max_ns * 1e-3 << std::endl;
+        }
+
+        task->PrintPerformanceCounters();
+
+        TaskArena::Counters arena;
+        if (task->GetArenaCounters(arena))
+        {
+            std::cout << "[RealTimeTaskManager]: \tRun() Arena " << (arena.armed ? "ARMED" : "WARMING UP") << " after " << arena.warmup_cycles
+                      << " cycles\tPeak: " << arena.peak_bytes << " of " << arena.capacity << " bytes"
+                      << "\tAllocations: " << arena.allocations << "\tOverflows: " << arena.overflows << " (" << arena.overflow_bytes << " bytes)"
+                      << "\tEscaped Cycles: " << arena.escaped_cycles << std::endl;
+        }
+
+        if (task->allocation_tracking_)
+        {
+            AllocationTracker::Counters counters;
+            uint64_t allocating_cycles;
+            task->GetAllocationCounters(counters, allocating_cycles);
+            std::cout << "[RealTimeTaskManager]: \tRun() Allocations: " << counters.allocations << " Frees: " << counters.frees
+                      << " Bytes: " << counters.bytes << " Allocating Cycles: " << allocating_cycles << std::endl;
+        }
+        std::cout << "[RealTimeTaskManager]: \tCycles: " << stats.cycles << "\tOverruns: " << stats.overruns
+                  << "\tRun Time (us) Mean: " << stats.MeanExecutionTime() * 1e-3
+                  << " P99: " << TaskStatistics::Snapshot::Percentile(stats.execution_histogram, 0.99) * 1e-3
+                  << " Max: " << stats.execution_max_ns * 1e-3
+                  << "\tLateness (us) Mean: " << stats.MeanLateness() * 1e-3
+                  << " P99: " << TaskStatistics::Snapshot::Percentile(stats.lateness_histogram, 0.99) * 1e-3
+                  << " Max: " << stats.lateness_max_ns * 1e-3 << std::endl;
+
+        // Slow code shows as CPU time, preemption and blocking as interference and context switches
+        if (stats.accounted_cycles > 0)
+        {
+            std::cout << "[RealTimeTaskManager]: \tCPU Time (us) Mean: " << stats.MeanCpuTime() * 1e-3
+                      << " P99: " << TaskStatistics::Snapshot::Percentile(stats.cpu_histogram, 0.99) * 1e-3
+                      << " Max: " << stats.cpu_max_ns * 1e-3
+                      << "\tInterference (us) Mean: " << stats.MeanInterference() * 1e-3
+                      << " Max: " << stats.interference_max_ns * 1e-3 << std::endl;
+            std::cout << "[RealTimeTaskManager]: \tContext Switches Voluntary: " << stats.voluntary_switches
+                      << " Involuntary: " << stats.involuntary_switches << " Preempted Cycles: " << stats.preempted_cycles
+                      << "\tRun() Faults Minor: " << stats.minor_faults << " Major: " << stats.major_faults
+                      << " Faulting Cycles: " << stats.faulting_cycles << std::endl;
+        }
     }
 }
 } // namespace Realtime
\ No newline at end of file
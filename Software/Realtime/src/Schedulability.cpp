@@ -0,0 +1,205 @@
+/*
+ * Schedulability.cpp
+ *
+ *  Created on: August 31, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <Realtime/Schedulability.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace Realtime
+{
+SchedulabilityAnalyzer::SchedulabilityAnalyzer() : cpu_count_(1), deadline_bandwidth_(1.0)
+{
+}
+
+void SchedulabilityAnalyzer::Clear()
+{
+    tasks_.clear();
+    results_.clear();
+}
+
+bool SchedulabilityAnalyzer::Analyze()
+{
+    results_.clear();
+
+    // SCHED_DEADLINE tasks are admitted against the bandwidth of the whole root domain
+    double deadline_utilization = 0.0;
+    double deadline_max_utilization = 0.0;
+
+    // Fixed priority tasks free to migrate.  Only the necessary utilization condition applies to them
+    double unpinned_utilization = 0.0;
+
+    for (const TaskModel &task : tasks_)
+    {
+        if (task.wcet_ns == 0 || task.period_ns == 0)
+            continue;
+
+        const double utilization = (double)task.wcet_ns / task.period_ns;
+        if (task.scheduling_class == EARLIEST_DEADLINE)
+        {
+            deadline_utilization += utilization;
+            deadline_max_utilization = std::max(deadline_max_utilization, utilization);
+        }
+        else if (task.scheduling_class == FIXED_PRIORITY && task.core < 0)
+        {
+            unpinned_utilization += utilization;
+        }
+    }
+
+    // Global EDF only guarantees deadlines under the GFB bound U <= M - (M - 1) * Umax.  Above it (and within the
+    // kernel's bandwidth) the tardiness is bounded but deadlines may be missed
+    const double deadline_capacity = cpu_count_ * deadline_bandwidth_;
+    const bool deadline_guaranteed = deadline_utilization <= cpu_count_ - (cpu_count_ - 1) * deadline_max_utilization;
+
+    bool feasible = true;
+    for (size_t i = 0; i < tasks_.size(); i++)
+    {
+        const TaskModel &task = tasks_[i];
+
+        Result result;
+        result.name = task.name;
+        result.analyzed = (task.wcet_ns > 0 && task.period_ns > 0);
+        result.feasible = true;
+        result.response_ns = 0;
+        result.utilization = result.analyzed ? (double)task.wcet_ns / task.period_ns : 0.0;
+
+        if (!result.analyzed)
+        {
+            result.test = "None (no WCET)";
+            results_.push_back(result);
+            continue;
+        }
+
+        if (task.scheduling_class == EARLIEST_DEADLINE)
+        {
+            // Within the kernel's bandwidth but above the GFB bound the kernel admits the task yet deadlines may be missed
+            result.test = deadline_guaranteed ? "EDF Utilization" : "EDF Utilization (GFB bound exceeded)";
+            result.feasible = result.utilization <= 1.0 && deadline_utilization <= deadline_capacity && deadline_guaranteed;
+        }
+        else if (task.scheduling_class == FIXED_PRIORITY && task.core >= 0)
+        {
+            // Higher and equal priority tasks that can run on this core.  Equal priorities count in full (FIFO order
+            // unknown).  Unpinned tasks may land on any core so they count against every core.  SCHED_DEADLINE
+            // tasks preempt every FIFO/RR task and count as top priority interference
+            std::vector<const TaskModel *> interference;
+            for (size_t j = 0; j < tasks_.size(); j++)
+            {
+                const TaskModel &other = tasks_[j];
+                if (j == i || other.wcet_ns == 0 || other.period_ns == 0 || (other.core >= 0 && other.core != task.core))
+                    continue;
+
+                if (other.scheduling_class == EARLIEST_DEADLINE ||
+                    (other.scheduling_class == FIXED_PRIORITY && other.sched_priority >= task.sched_priority))
+                {
+                    interference.push_back(&other);
+                }
+            }
+
+            result.test = "Response Time";
+            result.response_ns = ResponseTime(task, interference);
+            result.feasible = result.response_ns != 0;
+        }
+        else if (task.scheduling_class == FIXED_PRIORITY)
+        {
+            result.test = "Utilization (unpinned, necessary only)";
+            result.feasible = result.utilization <= 1.0 && unpinned_utilization <= cpu_count_;
+        }
+        else
+        {
+            result.test = "WCET <= Period";
+            result.feasible = task.wcet_ns <= task.period_ns;
+        }
+
+        feasible &= result.feasible;
+        results_.push_back(result);
+    }
+
+    return feasible;
+}
+
+uint64_t SchedulabilityAnalyzer::ResponseTime(const TaskModel &task, const std::vector<const TaskModel *> &interference)
+{
+    // Monotonic in R, so it either converges or passes the deadline
+    uint64_t response = task.wcet_ns;
+    while (true)
+    {
+        uint64_t next = task.wcet_ns;
+        for (const TaskModel *other : interference)
+        {
+            next += ((response + other->period_ns - 1) / other->period_ns) * other->wcet_ns;
+        }
+
+        if (next > task.period_ns)
+            return 0;
+
+        if (next == response)
+            return response;
+
+        response = next;
+    }
+}
+
+void SchedulabilityAnalyzer::Print() const
+{
+    double deadline_utilization = 0.0;
+    for (size_t i = 0; i < results_.size() && i < tasks_.size(); i++)
+    {
+        const TaskModel &task = tasks_[i];
+        const Result &result = results_[i];
+        if (task.scheduling_class == EARLIEST_DEADLINE)
+            deadline_utilization += result.utilization;
+
+        std::cout << "[SchedulabilityAnalyzer]: Task: " << task.name
+                  << "\tCore: " << (task.core >= 0 ? std::to_string(task.core) : std::string("Any"))
+                  << "\tPeriod (us): " << task.period_ns * 1e-3
+                  << "\tWCET (us): " << task.wcet_ns * 1e-3 << " (" << task.wcet_source << ")"
+                  << "\tU: " << result.utilization;
+
+        if (result.response_ns > 0)
+            std::cout << "\tResponse (us): " << result.response_ns * 1e-3;
+
+        std::cout << "\tTest: " << result.test << "\t"
+                  << (!result.analyzed ? "NOT ANALYZED" : (result.feasible ? "FEASIBLE" : "INFEASIBLE")) << std::endl;
+    }
+
+    if (deadline_utilization > 0.0)
+    {
+        std::cout << "[SchedulabilityAnalyzer]: SCHED_DEADLINE Utilization: " << deadline_utilization
+                  << " Capacity: " << cpu_count_ * deadline_bandwidth_ << std::endl;
+    }
+}
+
+double SchedulabilityAnalyzer::ReadDeadlineBandwidth()
+{
+    long runtime = -1;
+    long period = 0;
+
+    std::ifstream runtime_file("/proc/sys/kernel/sched_rt_runtime_us");
+    std::ifstream period_file("/proc/sys/kernel/sched_rt_period_us");
+    if (!(runtime_file >> runtime) || !(period_file >> period) || runtime < 0 || period <= 0)
+    {
+        return 1.0;
+    }
+    return (double)runtime / period;
+}
+} // namespace Realtime
@@ -0,0 +1,291 @@
+/*
+ * TaskArena.cpp
+ *
+ *  Created on: September 6, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <Realtime/TaskArena.hpp>
+
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include <iostream>
+#include <mutex>
+
+namespace Realtime
+{
+// Arena mapping as seen by free().  Records live in a static table, so a free() after the arena is destroyed still
+// lands on valid memory.  base is NULL while the record is unused
+struct TaskArena::Region
+{
+    std::atomic<unsigned char *> base;
+    std::atomic<size_t> capacity;
+
+    // Blocks not yet freed.  Decremented by whichever thread frees
+    std::atomic<int64_t> live;
+
+    // Arena destroyed with blocks live.  Unmapped once live drops to zero
+    std::atomic_bool orphaned;
+};
+
+namespace
+{
+// Block header.  Requested size, kept for realloc
+const size_t HEADER_SIZE = 16;
+
+// malloc alignment
+const size_t MIN_ALIGNMENT = alignof(max_align_t);
+
+// Arena mappings.  Scanned by free() on every thread, so records are read lock free
+TaskArena::Region registry[TaskArena::MAX_ARENAS];
+std::atomic<int> registry_size(0);
+std::mutex registry_mutex;
+
+// Active arena of this thread.  Plain __thread pointer so the hooks never allocate to reach it
+__thread TaskArena *active_arena = NULL;
+
+inline void Add(std::atomic<uint64_t> &counter, const uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+} // namespace
+
+TaskArena::TaskArena(const size_t capacity) : base_(NULL),
+                                              capacity_(capacity),
+                                              region_(NULL),
+                                              offset_(0),
+                                              armed_(false),
+                                              warmup_allocations_(0),
+                                              warmup_frees_(0),
+                                              cycles_(0),
+                                              warmup_cycles_(0),
+                                              allocations_(0),
+                                              bytes_(0),
+                                              peak_bytes_(0),
+                                              overflows_(0),
+                                              overflow_bytes_(0),
+                                              escaped_cycles_(0)
+{
+    // Mapped outside the heap so the arena never competes with it.  Populated so Run() takes no faults here
+    void *memory = mmap(NULL, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        std::cout << "[TaskArena]: Failed to map " << capacity_ << " bytes: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lck(registry_mutex);
+    const int size = registry_size.load();
+    int slot = 0;
+    for (; slot < size; slot++)
+    {
+        Region &region = registry[slot];
+        if (region.base.load() == NULL)
+            break;
+
+        // Orphaned mapping whose last block has since been freed.  Nothing can reach it anymore
+        if (region.orphaned.load() && region.live.load(std::memory_order_acquire) == 0)
+        {
+            unsigned char *base = region.base.load();
+            region.base.store(NULL);
+            munmap(base, region.capacity.load());
+            break;
+        }
+    }
+
+    if (slot == MAX_ARENAS)
+    {
+        std::cout << "[TaskArena]: More than " << MAX_ARENAS << " arenas.  Arena DISABLED." << std::endl;
+        munmap(memory, capacity_);
+        return;
+    }
+
+    // Base published last so Find() never pairs it with a stale capacity
+    base_ = static_cast<unsigned char *>(memory);
+    region_ = &registry[slot];
+    region_->capacity.store(capacity_);
+    region_->live.store(0);
+    region_->orphaned.store(false);
+    region_->base.store(base_, std::memory_order_release);
+    if (slot == size)
+        registry_size.store(size + 1);
+}
+
+TaskArena::~TaskArena()
+{
+    if (base_ == NULL)
+        return;
+
+    std::unique_lock<std::mutex> lck(registry_mutex);
+
+    // Blocks still held elsewhere would be freed into unmapped memory.  Leave the mapping with its record instead
+    const int64_t live = region_->live.load(std::memory_order_acquire);
+    if (live > 0)
+    {
+        std::cout << "[TaskArena]: " << live << " blocks still live.  Leaving " << capacity_ << " bytes mapped." << std::endl;
+        region_->orphaned.store(true);
+        return;
+    }
+
+    region_->base.store(NULL);
+    munmap(base_, capacity_);
+}
+
+void TaskArena::GetCounters(Counters &counters) const
+{
+    counters.capacity = capacity_;
+    counters.cycles = cycles_.load(std::memory_order_relaxed);
+    counters.warmup_cycles = warmup_cycles_.load(std::memory_order_relaxed);
+    counters.armed = armed_.load(std::memory_order_relaxed);
+    counters.allocations = allocations_.load(std::memory_order_relaxed);
+    counters.bytes = bytes_.load(std::memory_order_relaxed);
+    counters.peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+    counters.overflows = overflows_.load(std::memory_order_relaxed);
+    counters.overflow_bytes = overflow_bytes_.load(std::memory_order_relaxed);
+    counters.escaped_cycles = escaped_cycles_.load(std::memory_order_relaxed);
+    counters.live_blocks = region_ == NULL ? 0 : region_->live.load(std::memory_order_relaxed);
+}
+
+bool TaskArena::IsAvailable()
+{
+#ifdef REALTIME_ALLOCATION_TRACKER
+    return true;
+#else
+    return false;
+#endif
+}
+
+TaskArena *TaskArena::Begin(TaskArena *arena)
+{
+    // A task without an arena runs on the heap, even nested inside one that has
+    TaskArena *previous = active_arena;
+    if (arena == NULL || arena->base_ == NULL)
+    {
+        active_arena = NULL;
+        return previous;
+    }
+
+    // Rewind only once every block is back.  Acquire pairs with the release in Release() so frees on other threads
+    // are done with their blocks before the memory is reused
+    if (arena->region_->live.load(std::memory_order_acquire) == 0)
+        arena->offset_ = 0;
+
+    arena->warmup_allocations_ = 0;
+    arena->warmup_frees_ = 0;
+    Add(arena->cycles_, 1);
+    active_arena = arena;
+    return previous;
+}
+
+void TaskArena::End(TaskArena *previous)
+{
+    TaskArena *arena = active_arena;
+    active_arena = previous;
+    if (arena == NULL)
+        return;
+
+    if (!arena->armed_.load(std::memory_order_relaxed))
+    {
+        // Steady state once a cycle returns everything it allocated
+        Add(arena->warmup_cycles_, 1);
+        if (arena->warmup_allocations_ > 0 && arena->warmup_allocations_ == arena->warmup_frees_)
+            arena->armed_.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    if (arena->region_->live.load(std::memory_order_relaxed) > 0)
+        Add(arena->escaped_cycles_, 1);
+}
+
+void *TaskArena::Allocate(const size_t size, const size_t alignment)
+{
+    TaskArena *arena = active_arena;
+    if (arena == NULL)
+        return NULL;
+
+    if (!arena->armed_.load(std::memory_order_relaxed))
+    {
+        arena->warmup_allocations_++;
+        return NULL;
+    }
+
+    // Non power of two alignments are left to the heap
+    const size_t align = alignment < MIN_ALIGNMENT ? MIN_ALIGNMENT : alignment;
+    if ((align & (align - 1)) != 0)
+        return NULL;
+
+    const uintptr_t base = (uintptr_t)arena->base_;
+    const uintptr_t block = (base + arena->offset_ + HEADER_SIZE + align - 1) & ~(uintptr_t)(align - 1);
+    if (size > arena->capacity_ || block - base > arena->capacity_ - size)
+    {
+        Add(arena->overflows_, 1);
+        Add(arena->overflow_bytes_, size);
+        return NULL;
+    }
+
+    *reinterpret_cast<uint64_t *>(block - HEADER_SIZE) = size;
+    arena->offset_ = block - base + size;
+    arena->region_->live.fetch_add(1, std::memory_order_relaxed);
+
+    Add(arena->allocations_, 1);
+    Add(arena->bytes_, size);
+    if (arena->offset_ > arena->peak_bytes_.load(std::memory_order_relaxed))
+        arena->peak_bytes_.store(arena->offset_, std::memory_order_relaxed);
+
+    return reinterpret_cast<void *>(block);
+}
+
+bool TaskArena::Release(void *ptr)
+{
+    Region *region = Find(ptr);
+    if (region == NULL)
+    {
+        if (active_arena != NULL)
+            active_arena->warmup_frees_++;
+        return false;
+    }
+
+    region->live.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+bool TaskArena::BlockSize(const void *ptr, size_t &size)
+{
+    if (Find(ptr) == NULL)
+        return false;
+
+    size = *reinterpret_cast<const uint64_t *>((uintptr_t)ptr - HEADER_SIZE);
+    return true;
+}
+
+TaskArena::Region *TaskArena::Find(const void *ptr)
+{
+    const uintptr_t address = (uintptr_t)ptr;
+    const int size = registry_size.load(std::memory_order_acquire);
+    for (int i = 0; i < size; i++)
+    {
+        const uintptr_t base = (uintptr_t)registry[i].base.load(std::memory_order_acquire);
+        if (base != 0 && address >= base && address < base + registry[i].capacity.load(std::memory_order_relaxed))
+            return &registry[i];
+    }
+    return NULL;
+}
+} // namespace Realtime
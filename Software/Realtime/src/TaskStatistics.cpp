@@ -0,0 +1,179 @@
+/*
+ * TaskStatistics.cpp
+ *
+ *  Created on: August 12, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Realtime/TaskStatistics.hpp>
+
+#include <time.h>
+#include <sys/resource.h>
+
+namespace Realtime
+{
+TaskStatistics::TaskStatistics()
+{
+    Reset();
+}
+
+void TaskStatistics::Reset()
+{
+    cycles_ = 0;
+    overruns_ = 0;
+    execution_total_ns_ = 0;
+    execution_max_ns_ = 0;
+    lateness_total_ns_ = 0;
+    lateness_max_ns_ = 0;
+
+    accounted_cycles_ = 0;
+    cpu_total_ns_ = 0;
+    cpu_max_ns_ = 0;
+    interference_total_ns_ = 0;
+    interference_max_ns_ = 0;
+    voluntary_switches_ = 0;
+    involuntary_switches_ = 0;
+    preempted_cycles_ = 0;
+    minor_faults_ = 0;
+    major_faults_ = 0;
+    faulting_cycles_ = 0;
+
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        execution_histogram_[i] = 0;
+        lateness_histogram_[i] = 0;
+        cpu_histogram_[i] = 0;
+    }
+}
+
+void TaskStatistics::Record(uint64_t execution_ns, uint64_t lateness_ns, bool overrun)
+{
+    Increment(execution_total_ns_, execution_ns);
+    Increment(lateness_total_ns_, lateness_ns);
+    Max(execution_max_ns_, execution_ns);
+    Max(lateness_max_ns_, lateness_ns);
+
+    Increment(execution_histogram_[Bucket(execution_ns)], 1);
+    Increment(lateness_histogram_[Bucket(lateness_ns)], 1);
+
+    if (overrun)
+        Increment(overruns_, 1);
+
+    // Publish the cycle last so readers see a consistent count of histogram samples
+    cycles_.store(cycles_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void TaskStatistics::Record(uint64_t execution_ns, uint64_t lateness_ns, bool overrun, const Usage &start, const Usage &end)
+{
+    const uint64_t cpu_ns = end.cpu_ns - start.cpu_ns;
+    const uint64_t interference_ns = execution_ns > cpu_ns ? execution_ns - cpu_ns : 0;
+    const uint64_t involuntary = end.involuntary_switches - start.involuntary_switches;
+    const uint64_t minor = end.minor_faults - start.minor_faults;
+    const uint64_t major = end.major_faults - start.major_faults;
+
+    Increment(cpu_total_ns_, cpu_ns);
+    Max(cpu_max_ns_, cpu_ns);
+    Increment(cpu_histogram_[Bucket(cpu_ns)], 1);
+    Increment(interference_total_ns_, interference_ns);
+    Max(interference_max_ns_, interference_ns);
+
+    Increment(voluntary_switches_, end.voluntary_switches - start.voluntary_switches);
+    Increment(involuntary_switches_, involuntary);
+    Increment(minor_faults_, minor);
+    Increment(major_faults_, major);
+    if (involuntary > 0)
+        Increment(preempted_cycles_, 1);
+    if (minor + major > 0)
+        Increment(faulting_cycles_, 1);
+    Increment(accounted_cycles_, 1);
+
+    Record(execution_ns, lateness_ns, overrun);
+}
+
+void TaskStatistics::ReadUsage(Usage &usage)
+{
+    struct timespec cpu_time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time);
+    usage.cpu_ns = cpu_time.tv_sec * 1000000000ULL + cpu_time.tv_nsec;
+
+    struct rusage resources;
+    if (getrusage(RUSAGE_THREAD, &resources) != 0)
+    {
+        usage.voluntary_switches = usage.involuntary_switches = usage.minor_faults = usage.major_faults = 0;
+        return;
+    }
+    usage.voluntary_switches = resources.ru_nvcsw;
+    usage.involuntary_switches = resources.ru_nivcsw;
+    usage.minor_faults = resources.ru_minflt;
+    usage.major_faults = resources.ru_majflt;
+}
+
+void TaskStatistics::GetSnapshot(Snapshot &snapshot) const
+{
+    snapshot.cycles = cycles_.load(std::memory_order_acquire);
+    snapshot.overruns = overruns_.load(std::memory_order_relaxed);
+    snapshot.execution_total_ns = execution_total_ns_.load(std::memory_order_relaxed);
+    snapshot.execution_max_ns = execution_max_ns_.load(std::memory_order_relaxed);
+    snapshot.lateness_total_ns = lateness_total_ns_.load(std::memory_order_relaxed);
+    snapshot.lateness_max_ns = lateness_max_ns_.load(std::memory_order_relaxed);
+
+    snapshot.accounted_cycles = accounted_cycles_.load(std::memory_order_relaxed);
+    snapshot.cpu_total_ns = cpu_total_ns_.load(std::memory_order_relaxed);
+    snapshot.cpu_max_ns = cpu_max_ns_.load(std::memory_order_relaxed);
+    snapshot.interference_total_ns = interference_total_ns_.load(std::memory_order_relaxed);
+    snapshot.interference_max_ns = interference_max_ns_.load(std::memory_order_relaxed);
+    snapshot.voluntary_switches = voluntary_switches_.load(std::memory_order_relaxed);
+    snapshot.involuntary_switches = involuntary_switches_.load(std::memory_order_relaxed);
+    snapshot.preempted_cycles = preempted_cycles_.load(std::memory_order_relaxed);
+    snapshot.minor_faults = minor_faults_.load(std::memory_order_relaxed);
+    snapshot.major_faults = major_faults_.load(std::memory_order_relaxed);
+    snapshot.faulting_cycles = faulting_cycles_.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        snapshot.execution_histogram[i] = execution_histogram_[i].load(std::memory_order_relaxed);
+        snapshot.lateness_histogram[i] = lateness_histogram_[i].load(std::memory_order_relaxed);
+        snapshot.cpu_histogram[i] = cpu_histogram_[i].load(std::memory_order_relaxed);
+    }
+}
+
+uint64_t TaskStatistics::Snapshot::Percentile(const uint64_t (&histogram)[NUM_BUCKETS], double percentile)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        total += histogram[i];
+    }
+
+    if (total == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)(percentile * total);
+    uint64_t count = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        count += histogram[i];
+        if (count >= target && histogram[i] > 0)
+        {
+            return (2ULL << i) - 1;
+        }
+    }
+    return (2ULL << (NUM_BUCKETS - 1)) - 1;
+}
+} // namespace Realtime
@@ -0,0 +1,255 @@
+/*
+ * WorkerPool.cpp
+ *
+ *  Created on: August 28, 2019
+ *      Author: Quincy Jones
+ *
+ * Copyright (c) <2019> <Quincy Jones - quincy@implementedrobotics.com/>
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Realtime/WorkerPool.hpp>
+
+#include <assert.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace Realtime
+{
+static inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+static inline uint64_t MonotonicNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static inline void FutexWait(std::atomic<int> *word, const int expected)
+{
+    syscall(SYS_futex, reinterpret_cast<int *>(word), FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static inline void FutexWakeAll(std::atomic<int> *word)
+{
+    syscall(SYS_futex, reinterpret_cast<int *>(word), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+WorkerPool::WorkerPool(const std::string &name,
+                       const int num_workers,
+                       const unsigned int rt_priority,
+                       const long spin_time,
+                       const unsigned int stack_size) : name_(name),
+                                                        num_workers_(num_workers),
+                                                        rt_priority_(rt_priority),
+                                                        scheduling_policy_(SchedulingPolicy::FIFO),
+                                                        spin_time_(spin_time),
+                                                        stack_size_(stack_size),
+                                                        worker_cores_(num_workers, -1),
+                                                        running_(false),
+                                                        function_(NULL),
+                                                        context_(NULL),
+                                                        end_(0),
+                                                        grain_(1),
+                                                        next_(0),
+                                                        epoch_(0),
+                                                        active_(0),
+                                                        sleepers_(0),
+                                                        stop_(false)
+{
+    assert(num_workers >= 0);
+}
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+void WorkerPool::SetWorkerAffinity(const int worker, const int core)
+{
+    assert(worker >= 0 && worker < num_workers_);
+    worker_cores_[worker] = core;
+}
+
+bool WorkerPool::Start()
+{
+    if (running_)
+        return true;
+
+    // Workers start from generation 0.  A job dispatched before a worker first runs is still seen
+    stop_ = false;
+    epoch_ = 0;
+    threads_.clear();
+    for (int i = 0; i < num_workers_; i++)
+    {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN + stack_size_);
+
+        if (worker_cores_[i] >= 0)
+        {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(worker_cores_[i], &cpu_set);
+            pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpu_set);
+        }
+
+        pthread_t thread;
+        const int result = pthread_create(&thread, &attr, &WorkerPool::WorkerThread, this);
+        pthread_attr_destroy(&attr);
+        if (result != 0)
+        {
+            std::cout << "[WorkerPool]: " << name_ << "\tFailed to create worker " << i << ": " << result << std::endl;
+            num_workers_ = i;
+            break;
+        }
+        threads_.push_back(thread);
+
+        // Same priority mapping as the task nodes
+        if (scheduling_policy_ == SchedulingPolicy::FIFO || scheduling_policy_ == SchedulingPolicy::ROUND_ROBIN)
+        {
+            struct sched_param param;
+            param.sched_priority = RealTimeTaskNode::ToSchedPriority(rt_priority_);
+            const int policy = (scheduling_policy_ == SchedulingPolicy::FIFO) ? SCHED_FIFO : SCHED_RR;
+            if (!RealTimeTaskManager::Instance()->HasRealtimeCapability() || pthread_setschedparam(thread, policy, &param) != 0)
+            {
+                std::cout << "[WorkerPool]: " << name_ << "\tWorker " << i << " failed to set real time policy.  Running SCHED_OTHER." << std::endl;
+            }
+        }
+    }
+
+    running_ = true;
+    std::cout << "[WorkerPool]: " << name_ << "\tRunning " << num_workers_ << " workers." << std::endl;
+    return num_workers_ > 0;
+}
+
+void WorkerPool::Stop()
+{
+    if (!running_)
+        return;
+
+    stop_ = true;
+    epoch_.fetch_add(1);
+    FutexWakeAll(&epoch_);
+
+    for (pthread_t thread : threads_)
+    {
+        pthread_join(thread, NULL);
+    }
+    threads_.clear();
+    running_ = false;
+}
+
+void WorkerPool::Dispatch(const int begin, const int end, const int grain, ChunkFunction function, void *context)
+{
+    const int chunk = std::max(1, grain);
+    if (!running_ || num_workers_ == 0 || end - begin <= chunk)
+    {
+        function(context, begin, end);
+        return;
+    }
+
+    std::unique_lock<PortMutex> lck(dispatch_mutex_);
+
+    function_ = function;
+    context_ = context;
+    end_ = end;
+    grain_ = chunk;
+    next_.store(begin, std::memory_order_relaxed);
+    active_.store(num_workers_, std::memory_order_relaxed);
+
+    // Publish.  Sleepers are only woken if there are any, so spinning workers cost no syscall
+    epoch_.fetch_add(1);
+    if (sleepers_.load() > 0)
+    {
+        FutexWakeAll(&epoch_);
+    }
+
+    RunChunks();
+
+    // Join.  Every worker checks in once per job, so the job state can be reused right after.  Yield now and then in
+    // case a worker shares this core
+    int spins = 0;
+    while (active_.load(std::memory_order_acquire) != 0)
+    {
+        CpuRelax();
+        if ((++spins & 1023) == 0)
+            sched_yield();
+    }
+}
+
+void WorkerPool::RunChunks()
+{
+    while (true)
+    {
+        const int start = next_.fetch_add(grain_, std::memory_order_relaxed);
+        if (start >= end_)
+            break;
+
+        function_(context_, start, std::min(start + grain_, end_));
+    }
+}
+
+void *WorkerPool::WorkerThread(void *arg)
+{
+    WorkerPool *pool = static_cast<WorkerPool *>(arg);
+    const uint64_t spin_ns = pool->spin_time_ * 1000ULL;
+
+    int seen = 0;
+    while (true)
+    {
+        // Spin for the next job, then sleep
+        uint64_t spin_until = MonotonicNanoseconds() + spin_ns;
+        int current;
+        int spins = 0;
+        while ((current = pool->epoch_.load(std::memory_order_acquire)) == seen)
+        {
+            CpuRelax();
+            if ((++spins & 63) != 0 || MonotonicNanoseconds() < spin_until)
+                continue;
+
+            pool->sleepers_.fetch_add(1);
+            if (pool->epoch_.load() == seen)
+            {
+                FutexWait(&pool->epoch_, seen);
+            }
+            pool->sleepers_.fetch_sub(1);
+            spin_until = MonotonicNanoseconds() + spin_ns;
+        }
+        seen = current;
+
+        if (pool->stop_)
+            break;
+
+        pool->RunChunks();
+        pool->active_.fetch_sub(1, std::memory_order_release);
+    }
+    return NULL;
+}
+} // namespace Realtime
@@ -0,0 +1,197 @@
+#include <Realtime/TaskArena.hpp>
+
+#include <iostream>
+#include <stdlib.h>
+
+// Drives the arena through the static hooks directly, so no malloc interposition is needed.  Checks rewinding, blocks
+// escaping a cycle, overflow to the heap, nested arenas, and that an arena destroyed with a block still live keeps that
+// block freeable
+namespace
+{
+const size_t capacity = 64 * 1024;
+
+// One warm up cycle that frees what it allocated, so the arena arms
+void Arm(Realtime::TaskArena &arena)
+{
+    void *heap = malloc(32);
+    Realtime::TaskArena::Begin(&arena);
+    Realtime::TaskArena::Allocate(32, alignof(max_align_t));
+    Realtime::TaskArena::Release(heap);
+    Realtime::TaskArena::End();
+    free(heap);
+}
+} // namespace
+
+int main()
+{
+    int failures = 0;
+
+    // Rewinds once every block of the cycle is freed
+    {
+        Realtime::TaskArena arena(capacity);
+        Arm(arena);
+
+        Realtime::TaskArena::Begin(&arena);
+        void *first = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::Release(first);
+        Realtime::TaskArena::End();
+
+        Realtime::TaskArena::Begin(&arena);
+        void *second = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::Release(second);
+        Realtime::TaskArena::End();
+        if (first == NULL || second != first)
+        {
+            std::cout << "[TaskArenaTest]: Arena did not rewind with no live blocks" << std::endl;
+            failures++;
+        }
+    }
+
+    // A block escaping its cycle holds the rewind off until it is freed
+    {
+        Realtime::TaskArena arena(capacity);
+        Arm(arena);
+
+        Realtime::TaskArena::Begin(&arena);
+        void *escaped = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::End();
+
+        Realtime::TaskArena::Begin(&arena);
+        void *next = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::Release(next);
+        Realtime::TaskArena::End();
+        if (escaped == NULL || next == NULL || next <= escaped)
+        {
+            std::cout << "[TaskArenaTest]: Arena rewound over an escaped block" << std::endl;
+            failures++;
+        }
+
+        Realtime::TaskArena::Counters counters;
+        arena.GetCounters(counters);
+        // Both cycles ended with the escaped block live
+        if (counters.escaped_cycles != 2 || counters.live_blocks != 1)
+        {
+            std::cout << "[TaskArenaTest]: Escaped cycles: " << counters.escaped_cycles << " Live: " << counters.live_blocks << std::endl;
+            failures++;
+        }
+
+        Realtime::TaskArena::Release(escaped);
+        Realtime::TaskArena::Begin(&arena);
+        void *rewound = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::Release(rewound);
+        Realtime::TaskArena::End();
+        if (rewound != escaped)
+        {
+            std::cout << "[TaskArenaTest]: Arena did not rewind after the escaped block was freed" << std::endl;
+            failures++;
+        }
+    }
+
+    // Requests that do not fit fall back to the heap and are counted
+    {
+        Realtime::TaskArena arena(capacity);
+        Arm(arena);
+
+        Realtime::TaskArena::Begin(&arena);
+        void *fits = Realtime::TaskArena::Allocate(capacity / 2, alignof(max_align_t));
+        void *overflow = Realtime::TaskArena::Allocate(capacity / 2, alignof(max_align_t));
+        void *oversize = Realtime::TaskArena::Allocate(capacity * 2, alignof(max_align_t));
+        Realtime::TaskArena::Release(fits);
+        Realtime::TaskArena::End();
+
+        Realtime::TaskArena::Counters counters;
+        arena.GetCounters(counters);
+        if (fits == NULL || overflow != NULL || oversize != NULL || counters.overflows != 2 ||
+            counters.overflow_bytes != capacity / 2 + capacity * 2)
+        {
+            std::cout << "[TaskArenaTest]: Overflows: " << counters.overflows << " Bytes: " << counters.overflow_bytes << std::endl;
+            failures++;
+        }
+    }
+
+    // Nested arenas.  The outer arena is active again after the inner End(), and a NULL arena nests as the heap
+    {
+        Realtime::TaskArena outer(capacity);
+        Realtime::TaskArena inner(capacity);
+        Arm(outer);
+        Arm(inner);
+
+        Realtime::TaskArena *previous = Realtime::TaskArena::Begin(&outer);
+        Realtime::TaskArena *nested = Realtime::TaskArena::Begin(&inner);
+        void *inner_block = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::End(nested);
+
+        Realtime::TaskArena *heap = Realtime::TaskArena::Begin(NULL);
+        void *heap_block = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::End(heap);
+
+        void *outer_block = Realtime::TaskArena::Allocate(64, alignof(max_align_t));
+        Realtime::TaskArena::End(previous);
+
+        Realtime::TaskArena::Counters inner_counters;
+        Realtime::TaskArena::Counters outer_counters;
+        inner.GetCounters(inner_counters);
+        outer.GetCounters(outer_counters);
+        if (previous != NULL || nested != &outer || heap != &outer || heap_block != NULL || outer_block == NULL ||
+            inner_counters.live_blocks != 1 || outer_counters.live_blocks != 1)
+        {
+            std::cout << "[TaskArenaTest]: Nested arena not restored" << std::endl;
+            failures++;
+        }
+        if (Realtime::TaskArena::Allocate(64, alignof(max_align_t)) != NULL)
+        {
+            std::cout << "[TaskArenaTest]: Arena still active after the outer End()" << std::endl;
+            failures++;
+        }
+
+        Realtime::TaskArena::Release(inner_block);
+        Realtime::TaskArena::Release(outer_block);
+    }
+
+    Realtime::TaskArena *arena = new Realtime::TaskArena(capacity);
+    if (!arena->IsValid())
+    {
+        std::cout << "[TaskArenaTest]: Arena failed to map" << std::endl;
+        return 1;
+    }
+    Arm(*arena);
+
+    // Block escapes its cycle
+    Realtime::TaskArena::Begin(arena);
+    void *escaped = Realtime::TaskArena::Allocate(128, 64);
+    Realtime::TaskArena::End();
+    if (escaped == NULL)
+    {
+        std::cout << "[TaskArenaTest]: Armed arena did not serve the block" << std::endl;
+        return 1;
+    }
+
+    // Arena goes away first.  The block must stay writable and known to the registry
+    delete arena;
+    static_cast<unsigned char *>(escaped)[127] = 0xA5;
+
+    size_t size = 0;
+    if (!Realtime::TaskArena::BlockSize(escaped, size) || size != 128)
+    {
+        std::cout << "[TaskArenaTest]: Escaped block size lost after arena destroyed" << std::endl;
+        failures++;
+    }
+    if (!Realtime::TaskArena::Release(escaped))
+    {
+        std::cout << "[TaskArenaTest]: Escaped block not released after arena destroyed" << std::endl;
+        failures++;
+    }
+
+    // Next arena reclaims the drained mapping and starts clean
+    Realtime::TaskArena next(capacity);
+    Realtime::TaskArena::Counters counters;
+    next.GetCounters(counters);
+    if (!next.IsValid() || counters.live_blocks != 0)
+    {
+        std::cout << "[TaskArenaTest]: Arena after reclaim not clean" << std::endl;
+        failures++;
+    }
+
+    std::cout << "[TaskArenaTest]: " << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -30,6 +30,7 @@
 #include <ignition/math/Vector3.hh>
 
 #include <Communications/Messages/double_vec_t.hpp>
+#include <Systems/TscClock.hpp>
 // C++ Includes
 #include <string>
 
@@ -82,7 +83,8 @@ namespace gazebo
             tx_msg.data.resize(13);
 
             // TODO: Publish State
-            uint64_t time_now = sequence_num_++;
+            // Shared epoch time.  Comparable with the controller processes
+            uint64_t time_now = Systems::TscClock::Instance()->Now();
 
             // Move this back to the PORT portion
             tx_msg.timestamp = time_now;